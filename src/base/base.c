@@ -4,4 +4,6 @@
 #include "base_log.c"
 #include "base_prng.c"
 #include "base_math.c"
+#include "base_simd.c"
+#include "base_prof.c"
 
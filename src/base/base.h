@@ -6,5 +6,7 @@
 #include "base_log.h"
 #include "base_prng.h"
 #include "base_math.h"
+#include "base_simd.h"
+#include "base_prof.h"
 #include "base_img.h"
 
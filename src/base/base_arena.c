@@ -1,13 +1,43 @@
 
-mem_arena* arena_create(u64 reserve_size, u64 commit_size, u32 flags) {
-    u32 page_size = plat_page_size();
+#ifdef ARENA_TELEMETRY
+
+static u32 _arena_tracked_lock = 0;
+static mem_arena* _arena_tracked = NULL;
+
+static mem_arena_site _arena_sites[ARENA_TELEMETRY_MAX_SITES] = { 0 };
+static u32 _arena_sites_lock = 0;
+
+void _arena_lock(u32* lock) {
+    while (!ATOMIC_CAS_U32(lock, 0, 1)) {
+        plat_thread_yield();
+    }
+}
+
+void _arena_unlock(u32* lock) {
+    ATOMIC_STORE_U32(lock, 0);
+}
+
+#define _ARENA_STAT_COMMIT(arena, size) \
+    ((arena)->stats.num_commits++, (arena)->stats.commit_bytes += (size))
+
+#else
+
+#define _ARENA_STAT_COMMIT(arena, size)
+
+#endif
+
+// Blocks of growable arenas are created with this as well
+mem_arena* _arena_block_create(u64 reserve_size, u64 commit_size, u32 flags) {
+    u64 page_size = (flags & ARENA_FLAG_HUGE_PAGES) ?
+        PLAT_HUGE_PAGE_SIZE : plat_page_size();
 
     reserve_size = ALIGN_UP_POW2(reserve_size, page_size);
     commit_size = ALIGN_UP_POW2(commit_size, page_size);
 
-    mem_arena* arena = plat_mem_reserve(reserve_size);
+    mem_arena* arena = (flags & ARENA_FLAG_HUGE_PAGES) ?
+        plat_mem_reserve_huge(reserve_size) : plat_mem_reserve(reserve_size);
 
-    if (plat_mem_commit(arena, commit_size) == false) {
+    if (arena != NULL && plat_mem_commit(arena, commit_size) == false) {
         arena = NULL;
     }
 
@@ -15,6 +45,10 @@ mem_arena* arena_create(u64 reserve_size, u64 commit_size, u32 flags) {
         plat_fatal_error("Fatal error: unable to commit memory for arena", 1);
     }
 
+    if (flags & ARENA_FLAG_PREFAULT) {
+        plat_mem_prefault(arena, commit_size);
+    }
+
     // TODO: ASAN stuff for memory
 
     arena->current = arena;
@@ -32,15 +66,149 @@ mem_arena* arena_create(u64 reserve_size, u64 commit_size, u32 flags) {
     return arena;
 }
 
+// Released blocks, linked through `prev`, that are still committed
+// up to their `commit_pos`
+static THREAD_LOCAL mem_arena* _arena_block_cache = NULL;
+static THREAD_LOCAL u64 _arena_block_cache_size = 0;
+static THREAD_LOCAL u64 _arena_block_cache_max = ARENA_BLOCK_CACHE_SIZE;
+
+// New block for a growable arena, reused from the cache when there
+// is one of the same flags and at most twice the size
+mem_arena* _arena_block_get(mem_arena* arena, u64 reserve_size) {
+    u64 page_size = (arena->flags & ARENA_FLAG_HUGE_PAGES) ?
+        PLAT_HUGE_PAGE_SIZE : plat_page_size();
+    reserve_size = ALIGN_UP_POW2(reserve_size, page_size);
+
+    mem_arena** best = NULL;
+
+    for (mem_arena** block = &_arena_block_cache; *block != NULL; block = &(*block)->prev) {
+        u64 block_size = (*block)->reserve_size;
+
+        if (
+            (*block)->flags == arena->flags &&
+            block_size >= reserve_size && block_size / 2 <= reserve_size &&
+            (best == NULL || block_size < (*best)->reserve_size)
+        ) {
+            best = block;
+        }
+    }
+
+    if (best == NULL) {
+        mem_arena* block = _arena_block_create(
+            reserve_size, arena->commit_size, arena->flags
+        );
+
+#ifdef ARENA_TELEMETRY
+        arena->stats.num_reserves++;
+        _ARENA_STAT_COMMIT(arena, block->commit_pos);
+#endif
+
+        return block;
+    }
+
+    mem_arena* block = *best;
+    *best = block->prev;
+    _arena_block_cache_size -= block->reserve_size;
+
+    // Whatever was committed before stays committed
+    block->current = block;
+    block->prev = NULL;
+    block->commit_size = arena->commit_size;
+    block->base_pos = 0;
+    block->pos = ARENA_HEADER_SIZE;
+
+#ifdef ARENA_TELEMETRY
+    arena->stats.num_reuses++;
+#endif
+
+    return block;
+}
+
+void _arena_block_cache_trim(u64 max_size) {
+    while (_arena_block_cache != NULL && _arena_block_cache_size > max_size) {
+        mem_arena* block = _arena_block_cache;
+        _arena_block_cache = block->prev;
+        _arena_block_cache_size -= block->reserve_size;
+
+        plat_mem_release(block, block->reserve_size);
+    }
+}
+
+// Blocks of arenas that decommit are released, since
+// those arenas are meant to give their memory back
+void _arena_block_release(mem_arena* arena, mem_arena* block) {
+#ifdef ARENA_TELEMETRY
+    arena->stats.num_blocks--;
+#else
+    UNUSED(arena);
+#endif
+
+    if (
+        (block->flags & ARENA_FLAG_DECOMMIT) == 0 &&
+        _arena_block_cache_size + block->reserve_size <= _arena_block_cache_max
+    ) {
+        block->prev = _arena_block_cache;
+        _arena_block_cache = block;
+        _arena_block_cache_size += block->reserve_size;
+
+        return;
+    }
+
+#ifdef ARENA_TELEMETRY
+    arena->stats.num_releases++;
+#endif
+
+    plat_mem_release(block, block->reserve_size);
+}
+
+mem_arena* arena_create(u64 reserve_size, u64 commit_size, u32 flags) {
+    mem_arena* arena = _arena_block_create(reserve_size, commit_size, flags);
+
+#ifdef ARENA_TELEMETRY
+    arena->name = NULL;
+    arena->stats = (mem_arena_stats){
+        .peak_pos = arena->pos,
+        .num_blocks = 1,
+        .peak_blocks = 1,
+        .num_reserves = 1,
+    };
+    _ARENA_STAT_COMMIT(arena, arena->commit_pos);
+
+    _arena_lock(&_arena_tracked_lock);
+    arena->next_tracked = _arena_tracked;
+    _arena_tracked = arena;
+    _arena_unlock(&_arena_tracked_lock);
+#endif
+
+    return arena;
+}
+
 void arena_destroy(mem_arena* arena) {
+#ifdef ARENA_TELEMETRY
+    _arena_lock(&_arena_tracked_lock);
+
+    mem_arena** tracked = &_arena_tracked;
+    while (*tracked != NULL && *tracked != arena) {
+        tracked = &(*tracked)->next_tracked;
+    }
+
+    if (*tracked != NULL) {
+        *tracked = arena->next_tracked;
+    }
+
+    _arena_unlock(&_arena_tracked_lock);
+#endif
+
     mem_arena* current = arena->current;
 
-    while (current != NULL) {
+    while (current->prev != NULL) {
         mem_arena* prev = current->prev;
-        plat_mem_release(current, current->reserve_size);
+        _arena_block_release(arena, current);
 
         current = prev;
     }
+
+    plat_mem_release(current, current->reserve_size);
 }
 
 u64 arena_get_pos(mem_arena* arena) {
@@ -61,7 +229,6 @@ void* arena_push(mem_arena* arena, u64 size, b32 non_zero) {
 
         if (arena->flags & ARENA_FLAG_GROWABLE) {
             u64 reserve_size = arena->reserve_size;
-            u64 commit_size = arena->commit_size;
 
             if (size + ARENA_HEADER_SIZE > reserve_size) {
                 u32 page_size = plat_page_size();
@@ -71,11 +238,14 @@ void* arena_push(mem_arena* arena, u64 size, b32 non_zero) {
                 );
             }
 
-            mem_arena* new_arena = arena_create(
-                reserve_size, commit_size, arena->flags
-            );
+            mem_arena* new_arena = _arena_block_get(arena, reserve_size);
             new_arena->base_pos = current->base_pos + current->reserve_size;
 
+#ifdef ARENA_TELEMETRY
+            arena->stats.num_blocks++;
+            arena->stats.peak_blocks = MAX(arena->stats.peak_blocks, arena->stats.num_blocks);
+#endif
+
             mem_arena* prev_cur = current;
             current = new_arena;
             current->prev = prev_cur;
@@ -101,6 +271,11 @@ void* arena_push(mem_arena* arena, u64 size, b32 non_zero) {
             out = NULL;
         } else {
             current->commit_pos = new_commit_pos;
+            _ARENA_STAT_COMMIT(arena, commit_size);
+
+            if (current->flags & ARENA_FLAG_PREFAULT) {
+                plat_mem_prefault(commit_pointer, commit_size);
+            }
         }
     }
 
@@ -110,6 +285,12 @@ void* arena_push(mem_arena* arena, u64 size, b32 non_zero) {
 
     current->pos = new_pos;
 
+#ifdef ARENA_TELEMETRY
+    arena->stats.num_pushes++;
+    arena->stats.push_bytes += size;
+    arena->stats.peak_pos = MAX(arena->stats.peak_pos, current->base_pos + new_pos);
+#endif
+
     if (!non_zero) {
         memset(out, 0, size);
     }
@@ -118,39 +299,45 @@ void* arena_push(mem_arena* arena, u64 size, b32 non_zero) {
 }
 
 void arena_pop(mem_arena* arena, u64 size) {
-    size = MIN(size, arena_get_pos(arena));
+    u64 pos = arena_get_pos(arena);
+    u64 new_pos = pos - MIN(size, pos - ARENA_HEADER_SIZE);
 
+    // Positions count the unused end of every block but the last one,
+    // so blocks are released by where they start rather than by their size
     mem_arena* current = arena->current;
-    while (current != NULL && size > current->pos) {
+    while (current->prev != NULL && new_pos < current->base_pos + ARENA_HEADER_SIZE) {
         mem_arena* prev = current->prev;
-
-        size -= current->pos;
-        plat_mem_release(current, current->reserve_size);
+        _arena_block_release(arena, current);
 
         current = prev;
     }
 
     arena->current = current;
 
-    size = MIN(current->pos - ARENA_HEADER_SIZE, size);
-    current->pos -= size;
+    current->pos = MIN(current->pos, new_pos - current->base_pos);
 
     if (arena->flags & ARENA_FLAG_DECOMMIT) {
         u64 required_commit_pos = current->pos + current->commit_size - 1;
         required_commit_pos -= required_commit_pos % current->commit_size;
 
-        if (required_commit_pos < arena->commit_pos) {
+        // The block being popped, which is not the first one
+        // once a growable arena has grown
+        if (required_commit_pos < current->commit_pos) {
             u8* commit_pointer = (u8*)current + required_commit_pos;
+            u64 decommit_size = current->commit_pos - required_commit_pos;
 
-            if (!plat_mem_decommit(
-                commit_pointer, arena->commit_pos - required_commit_pos
-            )) {
+            if (!plat_mem_decommit(commit_pointer, decommit_size)) {
                 plat_fatal_error(
                     "Fatal error: failed to decommit arena memory", 1
                 );
             }
 
-            arena->commit_pos = required_commit_pos;
+            current->commit_pos = required_commit_pos;
+
+#ifdef ARENA_TELEMETRY
+            arena->stats.num_decommits++;
+            arena->stats.decommit_bytes += decommit_size;
+#endif
         }
     }
 }
@@ -178,12 +365,12 @@ void arena_temp_end(mem_arena_temp temp) {
     arena_pop_to(temp.arena, temp.start_pos);
 }
 
-static THREAD_LOCAL mem_arena* scratch_arenas[2] = { 0 };
+static THREAD_LOCAL mem_arena* scratch_arenas[ARENA_NUM_SCRATCH] = { 0 };
 
 mem_arena_temp arena_scratch_get(mem_arena** conflicts, u32 num_conflicts) {
     i32 scratch_index = -1;
 
-    for (i32 i = 0; i < 2; i++) {
+    for (i32 i = 0; i < ARENA_NUM_SCRATCH; i++) {
         b32 conflict_found = false;
 
         for (u32 j = 0; j < num_conflicts; j++) {
@@ -209,6 +396,7 @@ mem_arena_temp arena_scratch_get(mem_arena** conflicts, u32 num_conflicts) {
             ARENA_SCRATCH_COMMIT,
             ARENA_FLAG_GROWABLE
         );
+        arena_set_name(scratch_arenas[scratch_index], "scratch");
     }
 
     return arena_temp_begin(scratch_arenas[scratch_index]);
@@ -218,3 +406,182 @@ void arena_scratch_release(mem_arena_temp scratch) {
     arena_temp_end(scratch);
 }
 
+mem_scratch_mark arena_scratch_mark(void) {
+    mem_scratch_mark mark = { 0 };
+
+    // Arenas created after the mark are popped back to empty
+    for (u32 i = 0; i < ARENA_NUM_SCRATCH; i++) {
+        mark.pos[i] = scratch_arenas[i] == NULL ?
+            ARENA_HEADER_SIZE : arena_get_pos(scratch_arenas[i]);
+    }
+
+    return mark;
+}
+
+void arena_scratch_restore(mem_scratch_mark mark) {
+    for (u32 i = 0; i < ARENA_NUM_SCRATCH; i++) {
+        if (scratch_arenas[i] != NULL) {
+            arena_pop_to(scratch_arenas[i], mark.pos[i]);
+        }
+    }
+}
+
+void arena_scratch_free(void) {
+    for (u32 i = 0; i < ARENA_NUM_SCRATCH; i++) {
+        if (scratch_arenas[i] != NULL) {
+            arena_destroy(scratch_arenas[i]);
+            scratch_arenas[i] = NULL;
+        }
+    }
+
+    _arena_block_cache_trim(0);
+}
+
+void arena_block_cache_set_size(u64 max_size) {
+    _arena_block_cache_max = max_size;
+    _arena_block_cache_trim(max_size);
+}
+
+#ifdef ARENA_TELEMETRY
+
+void arena_set_name(mem_arena* arena, const char* name) {
+    arena->name = name;
+}
+
+mem_arena_stats arena_get_stats(mem_arena* arena) {
+    return arena->stats;
+}
+
+void* arena_push_site(
+    mem_arena* arena, u64 size, b32 non_zero, const char* file, u32 line
+) {
+    // `__FILE__` is the same pointer for every push in a file,
+    // so the pointer is hashed instead of the string
+    u64 hash = (u64)(uintptr_t)file ^ ((u64)line * 0x9e3779b97f4a7c15ull);
+    hash *= 0xff51afd7ed558ccdull;
+    u32 index = (u32)(hash >> 32) % ARENA_TELEMETRY_MAX_SITES;
+
+    mem_arena_site* site = NULL;
+
+    for (u32 i = 0; i < ARENA_TELEMETRY_MAX_SITES; i++) {
+        mem_arena_site* slot = &_arena_sites[(index + i) % ARENA_TELEMETRY_MAX_SITES];
+
+        // `line` is written last when a slot is claimed
+        u32 slot_line = ATOMIC_LOAD_U32(&slot->line);
+
+        if (slot_line == 0) {
+            _arena_lock(&_arena_sites_lock);
+
+            if (slot->line == 0) {
+                slot->file = file;
+                ATOMIC_STORE_U32(&slot->line, line);
+            }
+
+            _arena_unlock(&_arena_sites_lock);
+
+            slot_line = ATOMIC_LOAD_U32(&slot->line);
+        }
+
+        if (slot_line == line && slot->file == file) {
+            site = slot;
+            break;
+        }
+    }
+
+    // Sites past the table's capacity only count towards the arena stats
+    if (site != NULL) {
+        ATOMIC_ADD_U64(&site->num_pushes, 1);
+        ATOMIC_ADD_U64(&site->bytes, size);
+
+        u64 max_size = ATOMIC_LOAD_U64(&site->max_size);
+        while (size > max_size && !ATOMIC_CAS_U64(&site->max_size, max_size, size)) {
+            max_size = ATOMIC_LOAD_U64(&site->max_size);
+        }
+    }
+
+    return arena_push(arena, size, non_zero);
+}
+
+// Short human readable size, e.g. "12.5 MiB"
+void _arena_fmt_size(char* buf, u32 buf_size, u64 bytes) {
+    if (bytes < KiB(1)) {
+        snprintf(buf, buf_size, "%" PRIu64 " B", bytes);
+    } else if (bytes < MiB(1)) {
+        snprintf(buf, buf_size, "%.1f KiB", (f64)bytes / (f64)KiB(1));
+    } else if (bytes < GiB(1)) {
+        snprintf(buf, buf_size, "%.1f MiB", (f64)bytes / (f64)MiB(1));
+    } else {
+        snprintf(buf, buf_size, "%.1f GiB", (f64)bytes / (f64)GiB(1));
+    }
+}
+
+void arena_telemetry_report(FILE* out, u32 max_sites) {
+    char reserve[16], peak[16], pushed[16], committed[16], decommitted[16];
+
+    fprintf(
+        out, "%-16s %10s %10s %10s %12s %8s %17s %22s %22s\n",
+        "Arena", "Reserve", "Peak", "Pushed", "Pushes", "Blocks",
+        "Reserve/Rel/Reuse", "Commits", "Decommits"
+    );
+
+    _arena_lock(&_arena_tracked_lock);
+
+    for (mem_arena* arena = _arena_tracked; arena != NULL; arena = arena->next_tracked) {
+        mem_arena_stats stats = arena->stats;
+
+        _arena_fmt_size(reserve, sizeof(reserve), arena->reserve_size);
+        _arena_fmt_size(peak, sizeof(peak), stats.peak_pos);
+        _arena_fmt_size(pushed, sizeof(pushed), stats.push_bytes);
+        _arena_fmt_size(committed, sizeof(committed), stats.commit_bytes);
+        _arena_fmt_size(decommitted, sizeof(decommitted), stats.decommit_bytes);
+
+        fprintf(
+            out, "%-16s %10s %10s %10s %12" PRIu64 " %3u (%2u) %5u/%5u/%5u"
+            " %8" PRIu64 " (%10s) %8" PRIu64 " (%10s)\n",
+            arena->name == NULL ? "(unnamed)" : arena->name,
+            reserve, peak, pushed, stats.num_pushes,
+            stats.num_blocks, stats.peak_blocks,
+            stats.num_reserves, stats.num_releases, stats.num_reuses,
+            stats.num_commits, committed, stats.num_decommits, decommitted
+        );
+    }
+
+    _arena_unlock(&_arena_tracked_lock);
+
+    u16 order[ARENA_TELEMETRY_MAX_SITES];
+    u32 num_sites = 0;
+
+    // Insertion sort by bytes pushed, largest first
+    for (u32 i = 0; i < ARENA_TELEMETRY_MAX_SITES; i++) {
+        if (ATOMIC_LOAD_U32(&_arena_sites[i].line) == 0) { continue; }
+
+        u64 bytes = _arena_sites[i].bytes;
+        u32 j = num_sites++;
+
+        for (; j > 0 && _arena_sites[order[j - 1]].bytes < bytes; j--) {
+            order[j] = order[j - 1];
+        }
+
+        order[j] = (u16)i;
+    }
+
+    fprintf(out, "\n%-48s %12s %10s %10s\n", "Site", "Pushes", "Bytes", "Largest");
+
+    for (u32 i = 0; i < MIN(num_sites, max_sites); i++) {
+        const mem_arena_site* site = &_arena_sites[order[i]];
+
+        char location[64];
+        snprintf(location, sizeof(location), "%s:%u", site->file, site->line);
+
+        _arena_fmt_size(pushed, sizeof(pushed), site->bytes);
+        _arena_fmt_size(peak, sizeof(peak), site->max_size);
+
+        fprintf(
+            out, "%-48s %12" PRIu64 " %10s %10s\n",
+            location, site->num_pushes, pushed, peak
+        );
+    }
+}
+
+#endif
+
@@ -6,12 +6,51 @@
 #define ARENA_SCRATCH_RESERVE MiB(64)
 #define ARENA_SCRATCH_COMMIT KiB(64)
 
+// Default cap on the reserved bytes of released blocks of growable
+// arenas that each thread keeps to reuse, instead of unmapping them and
+// mapping new ones when the arena grows again
+#ifndef ARENA_BLOCK_CACHE_SIZE
+#   define ARENA_BLOCK_CACHE_SIZE MiB(128)
+#endif
+
 typedef enum {
     ARENA_FLAG_NONE = 0,
     ARENA_FLAG_GROWABLE = (1 << 0),
     ARENA_FLAG_DECOMMIT = (1 << 1),
+    // Aligns blocks and commits to `PLAT_HUGE_PAGE_SIZE`,
+    // so the OS can back them with huge pages
+    ARENA_FLAG_HUGE_PAGES = (1 << 2),
+    // Faults in memory as it is committed, rather than on first use
+    ARENA_FLAG_PREFAULT = (1 << 3),
 } mem_arena_flag;
 
+// Define ARENA_TELEMETRY to record usage stats of every arena,
+// and how much each `PUSH_*` call site allocates
+// Stats are kept on the first block of growable arenas
+typedef struct {
+    // Highest `arena_get_pos`
+    u64 peak_pos;
+
+    u64 num_pushes;
+    u64 push_bytes;
+
+    // Calls to `plat_mem_commit` and `plat_mem_decommit`
+    u64 num_commits;
+    u64 commit_bytes;
+    u64 num_decommits;
+    u64 decommit_bytes;
+
+    // Blocks of growable arenas, including the first one
+    u32 num_blocks;
+    u32 peak_blocks;
+
+    // Calls to `plat_mem_reserve` and `plat_mem_release` for blocks,
+    // and blocks taken from the thread's block cache instead
+    u32 num_reserves;
+    u32 num_releases;
+    u32 num_reuses;
+} mem_arena_stats;
+
 typedef struct mem_arena {
     struct mem_arena* current;
     struct mem_arena* prev;
@@ -24,6 +63,15 @@ typedef struct mem_arena {
     u64 commit_pos;
 
     u32 flags;
+
+#ifdef ARENA_TELEMETRY
+    // Shown in `arena_telemetry_report`
+    const char* name;
+    // Every arena that has not been destroyed
+    struct mem_arena* next_tracked;
+
+    mem_arena_stats stats;
+#endif
 } mem_arena;
 
 typedef struct {
@@ -31,11 +79,42 @@ typedef struct {
     u64 start_pos;
 } mem_arena_temp;
 
+typedef struct {
+    u64 pos[ARENA_NUM_SCRATCH];
+} mem_scratch_mark;
+
+#ifdef ARENA_TELEMETRY
+
+#define ARENA_TELEMETRY_MAX_SITES 1024
+
+typedef struct {
+    // NULL if the slot is unused
+    const char* file;
+    u32 line;
+
+    u64 num_pushes;
+    u64 bytes;
+    u64 max_size;
+} mem_arena_site;
+
+#define PUSH_STRUCT(arena, T) (T*)arena_push_site((arena), sizeof(T), false, __FILE__, __LINE__)
+#define PUSH_STRUCT_NZ(arena, T) (T*)arena_push_site((arena), sizeof(T), true, __FILE__, __LINE__)
+#define PUSH_ARRAY(arena, T, n) \
+    (T*)arena_push_site((arena), sizeof(T) * (u64)(n), false, __FILE__, __LINE__)
+#define PUSH_ARRAY_NZ(arena, T, n) \
+    (T*)arena_push_site((arena), sizeof(T) * (u64)(n), true, __FILE__, __LINE__)
+
+#else
+
 #define PUSH_STRUCT(arena, T) (T*)arena_push((arena), sizeof(T), false)
 #define PUSH_STRUCT_NZ(arena, T) (T*)arena_push((arena), sizeof(T), true)
 #define PUSH_ARRAY(arena, T, n) (T*)arena_push((arena), sizeof(T) * (u64)(n), false)
 #define PUSH_ARRAY_NZ(arena, T, n) (T*)arena_push((arena), sizeof(T) * (u64)(n), true)
 
+#define arena_set_name(arena, name) ((void)(arena), (void)(name))
+
+#endif
+
 mem_arena* arena_create(u64 reserve_size, u64 commit_size, u32 flags);
 void arena_destroy(mem_arena* arena);
 u64 arena_get_pos(mem_arena* arena);
@@ -49,4 +128,33 @@ void arena_temp_end(mem_arena_temp temp);
 
 mem_arena_temp arena_scratch_get(mem_arena** conflicts, u32 num_conflicts);
 void arena_scratch_release(mem_arena_temp scratch);
+// Positions of the calling thread's scratch arenas, so code that runs
+// work it does not own (e.g. a job system) can pop what the work left behind
+mem_scratch_mark arena_scratch_mark(void);
+void arena_scratch_restore(mem_scratch_mark mark);
+// Destroys the calling thread's scratch arenas, and releases its cached blocks
+// Threads other than the main thread should call this before exiting
+void arena_scratch_free(void);
+
+// Sets the calling thread's block cache cap, releasing cached blocks
+// past it (0 disables the cache)
+void arena_block_cache_set_size(u64 max_size);
+
+#ifdef ARENA_TELEMETRY
+
+// `name` has to outlive the arena
+void arena_set_name(mem_arena* arena, const char* name);
+mem_arena_stats arena_get_stats(mem_arena* arena);
+
+// Records the push under `file` and `line`, then calls `arena_push`
+void* arena_push_site(
+    mem_arena* arena, u64 size, b32 non_zero, const char* file, u32 line
+);
+
+// Writes a table of every live arena, then of the `max_sites` call sites
+// that pushed the most bytes, without allocating from any arena
+// Stats of arenas owned by other threads can be slightly out of date
+void arena_telemetry_report(FILE* out, u32 max_sites);
+
+#endif
 
@@ -50,6 +50,59 @@ typedef double f64;
 STATIC_ASSERT(sizeof(f32) == 4, f32_size);
 STATIC_ASSERT(sizeof(f64) == 8, f64_size);
 
+// Atomic operations on naturally aligned u32 and u64 values
+// All of them are sequentially consistent, apart from ATOMIC_STORE_RELEASE,
+// which only keeps earlier writes from being reordered after it
+// ATOMIC_ADD and ATOMIC_SUB return the new value, and ATOMIC_CAS returns
+// whether `*ptr` was equal to `expected` and was replaced with `desired`
+#if defined(COMPILER_CLANG) || defined(COMPILER_GCC)
+#   define ATOMIC_LOAD_U32(ptr) __atomic_load_n((u32*)(ptr), __ATOMIC_SEQ_CST)
+#   define ATOMIC_STORE_U32(ptr, val) __atomic_store_n((u32*)(ptr), (u32)(val), __ATOMIC_SEQ_CST)
+#   define ATOMIC_ADD_U32(ptr, val) __atomic_add_fetch((u32*)(ptr), (u32)(val), __ATOMIC_SEQ_CST)
+#   define ATOMIC_SUB_U32(ptr, val) __atomic_sub_fetch((u32*)(ptr), (u32)(val), __ATOMIC_SEQ_CST)
+#   define ATOMIC_CAS_U32(ptr, expected, desired) \
+        __sync_bool_compare_and_swap((u32*)(ptr), (u32)(expected), (u32)(desired))
+
+#   define ATOMIC_LOAD_U64(ptr) __atomic_load_n((u64*)(ptr), __ATOMIC_SEQ_CST)
+#   define ATOMIC_STORE_U64(ptr, val) __atomic_store_n((u64*)(ptr), (u64)(val), __ATOMIC_SEQ_CST)
+#   define ATOMIC_ADD_U64(ptr, val) __atomic_add_fetch((u64*)(ptr), (u64)(val), __ATOMIC_SEQ_CST)
+#   define ATOMIC_SUB_U64(ptr, val) __atomic_sub_fetch((u64*)(ptr), (u64)(val), __ATOMIC_SEQ_CST)
+#   define ATOMIC_CAS_U64(ptr, expected, desired) \
+        __sync_bool_compare_and_swap((u64*)(ptr), (u64)(expected), (u64)(desired))
+#   define ATOMIC_STORE_RELEASE_U64(ptr, val) \
+        __atomic_store_n((u64*)(ptr), (u64)(val), __ATOMIC_RELEASE)
+
+#   define ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif defined(COMPILER_MSVC)
+#   include <intrin.h>
+
+#   define ATOMIC_LOAD_U32(ptr) ((u32)_InterlockedOr((volatile long*)(ptr), 0))
+#   define ATOMIC_STORE_U32(ptr, val) ((void)_InterlockedExchange((volatile long*)(ptr), (long)(val)))
+#   define ATOMIC_ADD_U32(ptr, val) \
+        ((u32)_InterlockedExchangeAdd((volatile long*)(ptr), (long)(val)) + (u32)(val))
+#   define ATOMIC_SUB_U32(ptr, val) \
+        ((u32)_InterlockedExchangeAdd((volatile long*)(ptr), -(long)(val)) - (u32)(val))
+#   define ATOMIC_CAS_U32(ptr, expected, desired) (_InterlockedCompareExchange( \
+        (volatile long*)(ptr), (long)(desired), (long)(expected)) == (long)(expected))
+
+#   define ATOMIC_LOAD_U64(ptr) ((u64)_InterlockedOr64((volatile long long*)(ptr), 0))
+#   define ATOMIC_STORE_U64(ptr, val) \
+        ((void)_InterlockedExchange64((volatile long long*)(ptr), (long long)(val)))
+#   define ATOMIC_ADD_U64(ptr, val) \
+        ((u64)_InterlockedExchangeAdd64((volatile long long*)(ptr), (long long)(val)) + (u64)(val))
+#   define ATOMIC_SUB_U64(ptr, val) \
+        ((u64)_InterlockedExchangeAdd64((volatile long long*)(ptr), -(long long)(val)) - (u64)(val))
+#   define ATOMIC_CAS_U64(ptr, expected, desired) (_InterlockedCompareExchange64( \
+        (volatile long long*)(ptr), (long long)(desired), (long long)(expected)) == (long long)(expected))
+// Plain stores are release stores on x64
+#   define ATOMIC_STORE_RELEASE_U64(ptr, val) \
+        (_ReadWriteBarrier(), *(volatile u64*)(ptr) = (u64)(val))
+
+#   define ATOMIC_FENCE() _mm_mfence()
+#else
+#   error "Invalid compiler for atomics; Use Clang, GCC, or MSVC"
+#endif
+
 #define KiB(n) ((u64)(n) << 10)
 #define MiB(n) ((u64)(n) << 20)
 #define GiB(n) ((u64)(n) << 30)
@@ -0,0 +1,210 @@
+
+static THREAD_LOCAL prof_thread* _prof_cur_thread = NULL;
+
+static u32 _prof_lock = 0;
+static prof_thread* _prof_threads = NULL;
+static u32 _prof_num_threads = 0;
+
+static u64 _prof_init_ticks = 0;
+static u64 _prof_init_nsec = 0;
+
+void prof_init(void) {
+    _prof_init_ticks = prof_ticks();
+    _prof_init_nsec = plat_time_nsec();
+}
+
+u64 prof_ticks(void) {
+#if defined(ARCH_X64)
+    return __rdtsc();
+#elif defined(ARCH_ARM64) && (defined(COMPILER_CLANG) || defined(COMPILER_GCC))
+    u64 ticks = 0;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return plat_time_nsec();
+#endif
+}
+
+f64 prof_ticks_per_sec(void) {
+#if defined(ARCH_X64) || (defined(ARCH_ARM64) && (defined(COMPILER_CLANG) || defined(COMPILER_GCC)))
+    // The counters run at a constant rate on every cpu from the
+    // last decade, so it is measured over the life of the profiler
+    u64 ticks = prof_ticks();
+    u64 nsec = plat_time_nsec();
+
+    // Too short to measure the rate from
+    if (nsec - _prof_init_nsec < 1000000) {
+        plat_sleep_ms(2);
+
+        ticks = prof_ticks();
+        nsec = plat_time_nsec();
+    }
+
+    return (f64)(ticks - _prof_init_ticks) * 1e9 / (f64)(nsec - _prof_init_nsec);
+#else
+    return 1e9;
+#endif
+}
+
+void _prof_lock_acquire(void) {
+    while (!ATOMIC_CAS_U32(&_prof_lock, 0, 1)) {
+        plat_thread_yield();
+    }
+}
+
+void _prof_lock_release(void) {
+    ATOMIC_STORE_U32(&_prof_lock, 0);
+}
+
+prof_thread* _prof_thread_get(void) {
+    if (_prof_cur_thread != NULL) {
+        return _prof_cur_thread;
+    }
+
+    _prof_lock_acquire();
+
+    prof_thread* thread = _prof_threads;
+    while (thread != NULL && thread->in_use) {
+        thread = thread->next;
+    }
+
+    if (thread == NULL) {
+        u64 size = sizeof(prof_thread) + sizeof(prof_event) * PROF_EVENTS_PER_THREAD;
+        // Never destroyed, since the events are kept after the thread exits
+        mem_arena* arena = arena_create(size + KiB(4), KiB(64), ARENA_FLAG_NONE);
+        arena_set_name(arena, "prof");
+
+        thread = PUSH_STRUCT(arena, prof_thread);
+        thread->events = PUSH_ARRAY_NZ(arena, prof_event, PROF_EVENTS_PER_THREAD);
+        thread->index = _prof_num_threads++;
+
+        // Pushed to the back so lanes stay in creation order
+        prof_thread** last = &_prof_threads;
+        while (*last != NULL) { last = &(*last)->next; }
+        *last = thread;
+    }
+
+    thread->in_use = true;
+    thread->depth = 0;
+
+    _prof_lock_release();
+
+    _prof_cur_thread = thread;
+
+    return thread;
+}
+
+void prof_begin(const char* name) {
+    prof_thread* thread = _prof_thread_get();
+
+    u32 depth = thread->depth++;
+    if (depth >= PROF_MAX_DEPTH) { return; }
+
+    thread->stack_names[depth] = name;
+    thread->stack_starts[depth] = prof_ticks();
+}
+
+void prof_end(void) {
+    u64 end = prof_ticks();
+
+    prof_thread* thread = _prof_cur_thread;
+    if (thread == NULL || thread->depth == 0) { return; }
+
+    u32 depth = --thread->depth;
+    if (depth >= PROF_MAX_DEPTH) { return; }
+
+    u64 num_events = thread->num_events;
+
+    thread->events[num_events % PROF_EVENTS_PER_THREAD] = (prof_event){
+        .name = thread->stack_names[depth],
+        .start = thread->stack_starts[depth],
+        .end = end,
+    };
+
+    // Published after the event is written, for `prof_trace_json`
+    ATOMIC_STORE_RELEASE_U64(&thread->num_events, num_events + 1);
+}
+
+void prof_thread_release(void) {
+    if (_prof_cur_thread == NULL) { return; }
+
+    _prof_lock_acquire();
+    _prof_cur_thread->in_use = false;
+    _prof_lock_release();
+
+    _prof_cur_thread = NULL;
+}
+
+void _prof_json_name(mem_arena* arena, string8_list* list, const char* name) {
+    string8 str = str8_from_cstr((u8*)name);
+
+    b32 needs_escape = false;
+    for (u64 i = 0; i < str.size; i++) {
+        u8 c = str.str[i];
+        needs_escape |= c == '"' || c == '\\' || c < 0x20;
+    }
+
+    // Names are almost always identifiers, which can be added as is
+    if (!needs_escape) {
+        str8_list_add(arena, list, str);
+        return;
+    }
+
+    for (u64 i = 0; i < str.size; i++) {
+        u8 c = str.str[i];
+
+        if (c == '"' || c == '\\' || c < 0x20) {
+            str8_list_add(arena, list, str8_pushf(arena, "\\u%04x", c));
+        } else {
+            str8_list_add(arena, list, str8_substr_size(str, i, 1));
+        }
+    }
+}
+
+string8_list prof_trace_json(mem_arena* arena) {
+    string8_list list = { 0 };
+
+    f64 usec_per_tick = 1e6 / prof_ticks_per_sec();
+
+    str8_list_add(arena, &list, STR8_LIT("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+
+    _prof_lock_acquire();
+
+    b32 first = true;
+
+    for (prof_thread* thread = _prof_threads; thread != NULL; thread = thread->next) {
+        str8_list_add(arena, &list, str8_pushf(
+            arena, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":%u,"
+            "\"args\":{\"name\":\"Thread %u\"}}",
+            first ? "" : ",", thread->index, thread->index
+        ));
+        first = false;
+
+        u64 num_events = ATOMIC_LOAD_U64(&thread->num_events);
+        u64 start = num_events > PROF_EVENTS_PER_THREAD ?
+            num_events - PROF_EVENTS_PER_THREAD : 0;
+
+        for (u64 i = start; i < num_events; i++) {
+            const prof_event* event = &thread->events[i % PROF_EVENTS_PER_THREAD];
+
+            // Events from before `prof_init` would have negative times
+            if (event->start < _prof_init_ticks) { continue; }
+
+            str8_list_add(arena, &list, STR8_LIT(",\n{\"ph\":\"X\",\"name\":\""));
+            _prof_json_name(arena, &list, event->name);
+            str8_list_add(arena, &list, str8_pushf(
+                arena, "\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                thread->index,
+                (f64)(event->start - _prof_init_ticks) * usec_per_tick,
+                (f64)(event->end - event->start) * usec_per_tick
+            ));
+        }
+    }
+
+    _prof_lock_release();
+
+    str8_list_add(arena, &list, STR8_LIT("\n]}\n"));
+
+    return list;
+}
+
@@ -0,0 +1,80 @@
+
+#if defined(ARCH_X64) && (defined(COMPILER_CLANG) || defined(COMPILER_GCC))
+#   include <x86intrin.h>
+#endif
+
+// Hierarchical CPU profiler
+// Zones are recorded into a ring buffer per thread, which only its thread
+// writes to, and can be exported in the Chrome trace event format
+// (opened with chrome://tracing or https://ui.perfetto.dev)
+// Define PROF_DISABLED to compile the zone macros out
+
+// Events kept per thread, older ones are overwritten
+#define PROF_EVENTS_PER_THREAD (1 << 16)
+// Zones nested deeper than this are not recorded
+#define PROF_MAX_DEPTH 64
+
+typedef struct {
+    // Has to outlive the profiler, e.g. a string literal or `__func__`
+    const char* name;
+    u64 start;
+    u64 end;
+} prof_event;
+
+typedef struct prof_thread {
+    struct prof_thread* next;
+
+    // Lane of the thread in the trace
+    // Buffers of threads that have exited are reused by new threads
+    u32 index;
+    b32 in_use;
+
+    // Total events written, the last `PROF_EVENTS_PER_THREAD` of which are kept
+    u64 num_events;
+    prof_event* events;
+
+    u32 depth;
+    const char* stack_names[PROF_MAX_DEPTH];
+    u64 stack_starts[PROF_MAX_DEPTH];
+} prof_thread;
+
+#ifndef PROF_DISABLED
+
+#define PROF_BEGIN(name) prof_begin(name)
+#define PROF_END() prof_end()
+
+// Wraps the following statement or block in a zone
+// Jumping out of it (with `return`, `break`, or `goto`) skips the end of the zone
+#define PROF_SCOPE(name) for ( \
+    b32 CONCAT(_prof_once_, __LINE__) = (prof_begin(name), true); \
+    CONCAT(_prof_once_, __LINE__); \
+    CONCAT(_prof_once_, __LINE__) = (prof_end(), false))
+
+#else
+
+#define PROF_BEGIN(name)
+#define PROF_END()
+#define PROF_SCOPE(name)
+
+#endif
+
+// Has to be called once, after `plat_init` and before any zone
+void prof_init(void);
+
+// Timestamp used by zones, in units of `prof_ticks_per_sec`
+u64 prof_ticks(void);
+// Measured between `prof_init` and the call
+f64 prof_ticks_per_sec(void);
+
+void prof_begin(const char* name);
+void prof_end(void);
+
+// Lets a thread created later reuse the calling thread's buffer
+// Called by `plat_thread` when the thread's function returns
+void prof_thread_release(void);
+
+// Chrome trace event JSON of every kept event, with times
+// in microseconds since `prof_init`
+// Other threads should not be recording zones while this runs
+string8_list prof_trace_json(mem_arena* arena);
+
@@ -0,0 +1,286 @@
+
+// Written by `simd_init` before any other thread starts
+static simd_level _simd_cpu_level = SIMD_LEVEL_SCALAR;
+// A u32 so it can be read atomically by the threads
+// running kernels while `simd_set_level` changes it
+static u32 _simd_level = SIMD_LEVEL_SCALAR;
+
+simd_level _simd_detect(void) {
+#if defined(ARCH_X64)
+#   if defined(COMPILER_CLANG) || defined(COMPILER_GCC)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SIMD_LEVEL_AVX2;
+    }
+#   elif defined(COMPILER_MSVC)
+    i32 info[4] = { 0 };
+    __cpuid(info, 1);
+
+    b32 osxsave = (info[2] & (1 << 27)) != 0;
+    b32 avx = (info[2] & (1 << 28)) != 0;
+    b32 fma = (info[2] & (1 << 12)) != 0;
+
+    // Checking that the OS saves the ymm registers
+    if (osxsave && avx && fma && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(info, 7, 0);
+
+        if (info[1] & (1 << 5)) {
+            return SIMD_LEVEL_AVX2;
+        }
+    }
+#   endif
+
+    return SIMD_LEVEL_SSE2;
+#elif defined(ARCH_ARM64)
+    return SIMD_LEVEL_NEON;
+#else
+    return SIMD_LEVEL_SCALAR;
+#endif
+}
+
+void simd_init(void) {
+    _simd_cpu_level = _simd_detect();
+    ATOMIC_STORE_U32(&_simd_level, _simd_cpu_level);
+}
+
+simd_level simd_get_level(void) {
+    return (simd_level)ATOMIC_LOAD_U32(&_simd_level);
+}
+
+void simd_set_level(simd_level level) {
+    if (level == SIMD_LEVEL_SCALAR) {
+        ATOMIC_STORE_U32(&_simd_level, level);
+        return;
+    }
+
+#if defined(ARCH_X64)
+    if (level == SIMD_LEVEL_NEON) { return; }
+#elif defined(ARCH_ARM64)
+    if (level != SIMD_LEVEL_NEON) { return; }
+#endif
+
+    ATOMIC_STORE_U32(&_simd_level, MIN(level, _simd_cpu_level));
+}
+
+#define _BE16(m) (u16)(((u16)(m)[0] << 8) | (u16)(m)[1])
+#define _BE32(m) (u32)( \
+    ((u32)(m)[0] << 24) | ((u32)(m)[1] << 16) | \
+    ((u32)(m)[2] <<  8) | ((u32)(m)[3]))
+
+u32 _be32_sum_scalar(const u8* data, u64 count) {
+    u32 sum = 0;
+
+    for (u64 i = 0; i < count; i++) {
+        sum += _BE32(data + i * 4);
+    }
+
+    return sum;
+}
+
+void _be16_decode_scalar(u16* out, const u8* data, u64 count) {
+    for (u64 i = 0; i < count; i++) {
+        out[i] = _BE16(data + i * 2);
+    }
+}
+
+void _be32_decode_scalar(u32* out, const u8* data, u64 count) {
+    for (u64 i = 0; i < count; i++) {
+        out[i] = _BE32(data + i * 4);
+    }
+}
+
+#if defined(ARCH_X64)
+
+// SSE2 has no byte shuffle, so the swap is done with shifts
+__m128i _simd_bswap16_sse2(__m128i x) {
+    return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+__m128i _simd_bswap32_sse2(__m128i x) {
+    x = _simd_bswap16_sse2(x);
+    x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+u32 _simd_hsum_epi32(__m128i x) {
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (u32)_mm_cvtsi128_si32(x);
+}
+
+u32 _be32_sum_sse2(const u8* data, u64 count) {
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+
+    u64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(data + i * 4));
+        __m128i b = _mm_loadu_si128((const __m128i*)(data + i * 4 + 16));
+
+        acc0 = _mm_add_epi32(acc0, _simd_bswap32_sse2(a));
+        acc1 = _mm_add_epi32(acc1, _simd_bswap32_sse2(b));
+    }
+
+    u32 sum = _simd_hsum_epi32(_mm_add_epi32(acc0, acc1));
+
+    return sum + _be32_sum_scalar(data + i * 4, count - i);
+}
+
+void _be16_decode_sse2(u16* out, const u8* data, u64 count) {
+    u64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(data + i * 2));
+        _mm_storeu_si128((__m128i*)(out + i), _simd_bswap16_sse2(x));
+    }
+
+    _be16_decode_scalar(out + i, data + i * 2, count - i);
+}
+
+void _be32_decode_sse2(u32* out, const u8* data, u64 count) {
+    u64 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(data + i * 4));
+        _mm_storeu_si128((__m128i*)(out + i), _simd_bswap32_sse2(x));
+    }
+
+    _be32_decode_scalar(out + i, data + i * 4, count - i);
+}
+
+SIMD_TARGET_AVX2 u32 _be32_sum_avx2(const u8* data, u64 count) {
+    const __m256i shuffle = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+    );
+
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+
+    u64 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(data + i * 4));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(data + i * 4 + 32));
+
+        acc0 = _mm256_add_epi32(acc0, _mm256_shuffle_epi8(a, shuffle));
+        acc1 = _mm256_add_epi32(acc1, _mm256_shuffle_epi8(b, shuffle));
+    }
+
+    acc0 = _mm256_add_epi32(acc0, acc1);
+    __m128i acc = _mm_add_epi32(
+        _mm256_castsi256_si128(acc0),
+        _mm256_extracti128_si256(acc0, 1)
+    );
+
+    u32 sum = _simd_hsum_epi32(acc);
+
+    return sum + _be32_sum_scalar(data + i * 4, count - i);
+}
+
+SIMD_TARGET_AVX2 void _be16_decode_avx2(u16* out, const u8* data, u64 count) {
+    const __m256i shuffle = _mm256_setr_epi8(
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14
+    );
+
+    u64 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(data + i * 2));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_shuffle_epi8(x, shuffle));
+    }
+
+    _be16_decode_scalar(out + i, data + i * 2, count - i);
+}
+
+SIMD_TARGET_AVX2 void _be32_decode_avx2(u32* out, const u8* data, u64 count) {
+    const __m256i shuffle = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+    );
+
+    u64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(data + i * 4));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_shuffle_epi8(x, shuffle));
+    }
+
+    _be32_decode_scalar(out + i, data + i * 4, count - i);
+}
+
+#elif defined(ARCH_ARM64)
+
+u32 _be32_sum_neon(const u8* data, u64 count) {
+    uint32x4_t acc0 = vdupq_n_u32(0);
+    uint32x4_t acc1 = vdupq_n_u32(0);
+
+    u64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x16_t a = vld1q_u8(data + i * 4);
+        uint8x16_t b = vld1q_u8(data + i * 4 + 16);
+
+        acc0 = vaddq_u32(acc0, vreinterpretq_u32_u8(vrev32q_u8(a)));
+        acc1 = vaddq_u32(acc1, vreinterpretq_u32_u8(vrev32q_u8(b)));
+    }
+
+    u32 sum = vaddvq_u32(vaddq_u32(acc0, acc1));
+
+    return sum + _be32_sum_scalar(data + i * 4, count - i);
+}
+
+void _be16_decode_neon(u16* out, const u8* data, u64 count) {
+    u64 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x16_t x = vld1q_u8(data + i * 2);
+        vst1q_u16(out + i, vreinterpretq_u16_u8(vrev16q_u8(x)));
+    }
+
+    _be16_decode_scalar(out + i, data + i * 2, count - i);
+}
+
+void _be32_decode_neon(u32* out, const u8* data, u64 count) {
+    u64 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t x = vld1q_u8(data + i * 4);
+        vst1q_u32(out + i, vreinterpretq_u32_u8(vrev32q_u8(x)));
+    }
+
+    _be32_decode_scalar(out + i, data + i * 4, count - i);
+}
+
+#endif
+
+u32 be32_sum(const u8* data, u64 count) {
+    switch (simd_get_level()) {
+#if defined(ARCH_X64)
+        case SIMD_LEVEL_AVX2: return _be32_sum_avx2(data, count);
+        case SIMD_LEVEL_SSE2: return _be32_sum_sse2(data, count);
+#elif defined(ARCH_ARM64)
+        case SIMD_LEVEL_NEON: return _be32_sum_neon(data, count);
+#endif
+        default: return _be32_sum_scalar(data, count);
+    }
+}
+
+void be16_decode(u16* out, const u8* data, u64 count) {
+    switch (simd_get_level()) {
+#if defined(ARCH_X64)
+        case SIMD_LEVEL_AVX2: _be16_decode_avx2(out, data, count); break;
+        case SIMD_LEVEL_SSE2: _be16_decode_sse2(out, data, count); break;
+#elif defined(ARCH_ARM64)
+        case SIMD_LEVEL_NEON: _be16_decode_neon(out, data, count); break;
+#endif
+        default: _be16_decode_scalar(out, data, count); break;
+    }
+}
+
+void be32_decode(u32* out, const u8* data, u64 count) {
+    switch (simd_get_level()) {
+#if defined(ARCH_X64)
+        case SIMD_LEVEL_AVX2: _be32_decode_avx2(out, data, count); break;
+        case SIMD_LEVEL_SSE2: _be32_decode_sse2(out, data, count); break;
+#elif defined(ARCH_ARM64)
+        case SIMD_LEVEL_NEON: _be32_decode_neon(out, data, count); break;
+#endif
+        default: _be32_decode_scalar(out, data, count); break;
+    }
+}
+
@@ -0,0 +1,56 @@
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define ARCH_X64
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#   define ARCH_ARM64
+#endif
+
+#if defined(ARCH_X64)
+#   include <immintrin.h>
+#   if defined(COMPILER_MSVC)
+#       include <intrin.h>
+#   endif
+#elif defined(ARCH_ARM64)
+#   include <arm_neon.h>
+#endif
+
+// Allows AVX2 intrinsics in a single function
+// without compiling the whole program for AVX2
+#if defined(ARCH_X64) && (defined(COMPILER_CLANG) || defined(COMPILER_GCC))
+#   define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#   define SIMD_TARGET_AVX2
+#endif
+
+typedef enum {
+    SIMD_LEVEL_SCALAR = 0,
+
+    // Baseline on x64
+    SIMD_LEVEL_SSE2,
+    SIMD_LEVEL_AVX2,
+
+    // Baseline on arm64
+    SIMD_LEVEL_NEON,
+} simd_level;
+
+// Detects the highest instruction set supported by the CPU
+// Called by `plat_init`, before any other thread is started
+void simd_init(void);
+
+// Level the kernels run at, the detected one unless overridden
+// Scalar until `simd_init` is called
+simd_level simd_get_level(void);
+
+// Overrides the detected level (e.g. for comparing against the scalar path)
+// Levels above what the CPU supports are ignored
+void simd_set_level(simd_level level);
+
+// Sums `count` big-endian u32s, wrapping on overflow
+// `data` does not need to be aligned
+u32 be32_sum(const u8* data, u64 count);
+
+// Decodes `count` big-endian values into `out`
+// Neither pointer needs to be aligned
+void be16_decode(u16* out, const u8* data, u64 count);
+void be32_decode(u32* out, const u8* data, u64 count);
+
@@ -2,7 +2,7 @@
 string8 str8_from_cstr(u8* cstr) {
     u8* start = cstr;
 
-    while (*(cstr++));
+    while (*cstr) { cstr++; }
 
     return (string8) {
         .str = start,
@@ -11,7 +11,7 @@ string8 str8_from_cstr(u8* cstr) {
 }
 
 u8* str8_to_cstr(mem_arena* arena, string8 str) {
-    u8* out = PUSH_ARRAY_NZ(arena, u8, str.size);
+    u8* out = PUSH_ARRAY_NZ(arena, u8, str.size + 1);
 
     memcpy(out, str.str, str.size);
     out[str.size] = '\0';
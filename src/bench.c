@@ -0,0 +1,1378 @@
+#include "base/base.h"
+#include "platform/platform.h"
+#include "truetype/truetype.h"
+
+#include "base/base.c"
+#include "platform/platform.c"
+#include "truetype/truetype.c"
+
+// Headless benchmarks of the hot paths, run with the fonts given
+// on the command line (e.g. `Octopus_bench res/*.ttf`)
+// Pass `--json <file>` to also write the results as JSON,
+// `--trace <file>` to write the profiler's zones as a Chrome trace,
+// and `--filter <text>` to only run benchmarks whose name contains it
+
+// Samples are grown until one takes at least this long,
+// so the timer resolution does not matter
+#define BENCH_MIN_SAMPLE_NS 100000
+#define BENCH_MIN_SAMPLES 16
+#define BENCH_MAX_SAMPLES 1000
+#define BENCH_MIN_TIME_NS 200000000
+
+#define BENCH_MAX_METRICS 8
+
+// Runs `num_ops` operations of a benchmark
+typedef void (bench_func)(void* arg, u64 num_ops);
+
+typedef struct bench_result {
+    struct bench_result* next;
+
+    string8 name;
+    // Empty for benchmarks that do not use a font
+    string8 font;
+
+    u64 ops_per_sample;
+    u32 num_samples;
+    // Nanoseconds per operation of each sample, sorted
+    f64* sample_ns;
+
+    // Amount of `unit` processed by each operation, for the throughput
+    f64 units_per_op;
+    const char* unit;
+
+    // Results of checks done alongside the timing
+    u32 num_metrics;
+    const char* metric_names[BENCH_MAX_METRICS];
+    f64 metric_values[BENCH_MAX_METRICS];
+} bench_result;
+
+typedef struct {
+    mem_arena* arena;
+    string8 filter;
+
+    bench_result* first;
+    bench_result* last;
+} bench_context;
+
+int _bench_f64_cmp(const void* a, const void* b) {
+    f64 x = *(const f64*)a;
+    f64 y = *(const f64*)b;
+
+    return (x > y) - (x < y);
+}
+
+f64 bench_percentile(const bench_result* res, f64 p) {
+    u32 index = (u32)(p * (f64)(res->num_samples - 1) + 0.5);
+    return res->sample_ns[index];
+}
+
+f64 bench_mean(const bench_result* res) {
+    f64 sum = 0.0;
+    for (u32 i = 0; i < res->num_samples; i++) {
+        sum += res->sample_ns[i];
+    }
+
+    return sum / (f64)res->num_samples;
+}
+
+b32 bench_enabled(bench_context* ctx, string8 name) {
+    if (ctx->filter.size == 0) { return true; }
+
+    for (u64 i = 0; i + ctx->filter.size <= name.size; i++) {
+        if (str8_equals(str8_substr_size(name, i, ctx->filter.size), ctx->filter)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Returns NULL if the benchmark is filtered out
+bench_result* bench_run(
+    bench_context* ctx, string8 name, string8 font,
+    bench_func* func, void* arg
+) {
+    if (!bench_enabled(ctx, name)) { return NULL; }
+
+    // Warming up, and finding how many operations make a long enough sample
+    u64 ops = 1;
+    while (true) {
+        u64 start = plat_time_nsec();
+        func(arg, ops);
+        u64 elapsed = plat_time_nsec() - start;
+
+        if (elapsed >= BENCH_MIN_SAMPLE_NS || ops >= ((u64)1 << 32)) { break; }
+
+        ops *= 2;
+    }
+
+    // Names are often pushed on arenas that are popped between benchmarks
+    bench_result* res = PUSH_STRUCT(ctx->arena, bench_result);
+    res->name = str8_copy(ctx->arena, name);
+    res->font = str8_copy(ctx->arena, font);
+    res->ops_per_sample = ops;
+    res->sample_ns = PUSH_ARRAY_NZ(ctx->arena, f64, BENCH_MAX_SAMPLES);
+
+    u64 total_ns = 0;
+    while (
+        res->num_samples < BENCH_MAX_SAMPLES &&
+        (res->num_samples < BENCH_MIN_SAMPLES || total_ns < BENCH_MIN_TIME_NS)
+    ) {
+        u64 start = plat_time_nsec();
+        func(arg, ops);
+        u64 elapsed = plat_time_nsec() - start;
+
+        total_ns += elapsed;
+        res->sample_ns[res->num_samples++] = (f64)elapsed / (f64)ops;
+    }
+
+    qsort(res->sample_ns, res->num_samples, sizeof(f64), _bench_f64_cmp);
+
+    SLL_PUSH_BACK(ctx->first, ctx->last, res);
+
+    printf(
+        "%-40.*s %-28.*s %12.1f ns/op  p50 %10.1f  p99 %10.1f\n",
+        STR8_FMT(name), STR8_FMT(font), bench_mean(res),
+        bench_percentile(res, 0.5), bench_percentile(res, 0.99)
+    );
+
+    return res;
+}
+
+void bench_set_unit(bench_result* res, f64 units_per_op, const char* unit) {
+    if (res == NULL) { return; }
+
+    res->units_per_op = units_per_op;
+    res->unit = unit;
+}
+
+void bench_add_metric(bench_result* res, const char* name, f64 value) {
+    if (res == NULL || res->num_metrics >= BENCH_MAX_METRICS) { return; }
+
+    res->metric_names[res->num_metrics] = name;
+    res->metric_values[res->num_metrics] = value;
+    res->num_metrics++;
+
+    printf("    %s = %g\n", name, value);
+}
+
+// Base layer
+
+typedef struct {
+    mem_arena* arena;
+    u64 size;
+} bench_arena_arg;
+
+void bench_arena_push_pop(void* arg, u64 num_ops) {
+    bench_arena_arg* a = (bench_arena_arg*)arg;
+
+    for (u64 i = 0; i < num_ops; i++) {
+        volatile u8* mem = (u8*)arena_push(a->arena, a->size, true);
+        mem[0] = (u8)i;
+        arena_pop(a->arena, a->size);
+    }
+}
+
+// Spills into a second block of a growable arena, then pops back
+// into the first one, as a scratch arena near its reserve would
+void bench_arena_spill(void* arg, u64 num_ops) {
+    mem_arena* arena = (mem_arena*)arg;
+
+    for (u64 i = 0; i < num_ops; i++) {
+        mem_arena_temp temp = arena_temp_begin(arena);
+
+        volatile u8* a = (u8*)arena_push(arena, KiB(48), true);
+        volatile u8* b = (u8*)arena_push(arena, KiB(32), true);
+        a[0] = b[0] = (u8)i;
+
+        arena_temp_end(temp);
+    }
+}
+
+typedef struct {
+    u64* data;
+    u64 count;
+    // Carried over between samples, so they do not all
+    // read the same addresses, which would then be cached
+    u64 state;
+} bench_random_access_arg;
+
+void bench_random_access(void* arg, u64 num_ops) {
+    bench_random_access_arg* a = (bench_random_access_arg*)arg;
+
+    u64 mask = a->count - 1;
+    u64 state = a->state;
+    u64 sum = 0;
+
+    for (u64 i = 0; i < num_ops; i++) {
+        // xorshift64, inline so the timing is dominated by the loads
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        // Each address depends on the last load, so misses do not overlap
+        sum += a->data[(state + sum) & mask];
+    }
+
+    a->state = state;
+
+    volatile u64 sink = sum;
+    UNUSED(sink);
+}
+
+void bench_str8_pushf(void* arg, u64 num_ops) {
+    mem_arena* arena = (mem_arena*)arg;
+
+    for (u64 i = 0; i < num_ops; i++) {
+        mem_arena_temp temp = arena_temp_begin(arena);
+
+        volatile u64 size = str8_pushf(
+            arena, "glyph %u at (%.2f, %.2f) in %s", (u32)i,
+            (f64)i * 0.5, (f64)i * 0.25, "bench"
+        ).size;
+        UNUSED(size);
+
+        arena_temp_end(temp);
+    }
+}
+
+void bench_prof_zone(void* arg, u64 num_ops) {
+    UNUSED(arg);
+
+    for (u64 i = 0; i < num_ops; i++) {
+        PROF_BEGIN("bench_prof_zone");
+        PROF_END();
+    }
+}
+
+// Platform layer
+
+// Jobs submitted before each wait
+#define BENCH_JOBS_BATCH 256
+// Leaves of the stress test's job tree are `2^depth`
+#define BENCH_JOBS_TREE_DEPTH 10
+
+typedef struct {
+    u32 work;
+    u64 seed;
+    u64 result;
+} bench_job_slot;
+
+u64 bench_hash(u64 h, u32 work) {
+    for (u32 i = 0; i < work; i++) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+    }
+
+    return h;
+}
+
+void bench_job_hash(void* arg) {
+    bench_job_slot* slot = (bench_job_slot*)arg;
+    slot->result = bench_hash(slot->seed, slot->work);
+}
+
+typedef struct {
+    plat_job_system* jobs;
+    bench_job_slot slots[BENCH_JOBS_BATCH];
+} bench_jobs_arg;
+
+void bench_jobs_batch(void* arg, u64 num_ops) {
+    bench_jobs_arg* a = (bench_jobs_arg*)arg;
+
+    for (u64 i = 0; i < num_ops; i += BENCH_JOBS_BATCH) {
+        u32 count = (u32)MIN(BENCH_JOBS_BATCH, num_ops - i);
+        plat_job_counter counter = { 0 };
+
+        for (u32 j = 0; j < count; j++) {
+            a->slots[j].seed = i + j;
+            plat_jobs_submit(a->jobs, bench_job_hash, &a->slots[j], &counter);
+        }
+
+        plat_jobs_wait(a->jobs, &counter);
+    }
+}
+
+typedef struct {
+    plat_job_system* jobs;
+    u32 depth;
+    u64* num_leaves;
+} bench_job_node;
+
+// Every node waits on its children from inside a job
+void bench_job_tree(void* arg) {
+    bench_job_node* node = (bench_job_node*)arg;
+
+    if (node->depth == 0) {
+        ATOMIC_ADD_U64(node->num_leaves, 1);
+        return;
+    }
+
+    // Left on the scratch arena on purpose, for the job system to pop
+    mem_arena_temp scratch = arena_scratch_get(NULL, 0);
+    PUSH_ARRAY(scratch.arena, u8, 256);
+
+    bench_job_node children[2] = {
+        { node->jobs, node->depth - 1, node->num_leaves },
+        { node->jobs, node->depth - 1, node->num_leaves },
+    };
+
+    plat_job_counter counter = { 0 };
+    plat_jobs_submit(node->jobs, bench_job_tree, &children[0], &counter);
+    plat_jobs_submit(node->jobs, bench_job_tree, &children[1], &counter);
+    plat_jobs_wait(node->jobs, &counter);
+}
+
+void bench_job_increment(void* arg) {
+    ATOMIC_ADD_U64((u64*)arg, 1);
+}
+
+typedef struct {
+    plat_job_system* jobs;
+    u64 lost_jobs;
+} bench_jobs_stress_arg;
+
+void bench_jobs_stress(void* arg, u64 num_ops) {
+    bench_jobs_stress_arg* a = (bench_jobs_stress_arg*)arg;
+
+    for (u64 i = 0; i < num_ops; i++) {
+        u64 num_leaves = 0;
+        bench_job_node root = { a->jobs, BENCH_JOBS_TREE_DEPTH, &num_leaves };
+
+        plat_job_counter counter = { 0 };
+        plat_jobs_submit(a->jobs, bench_job_tree, &root, &counter);
+        plat_jobs_wait(a->jobs, &counter);
+
+        a->lost_jobs += ((u64)1 << BENCH_JOBS_TREE_DEPTH) - num_leaves;
+    }
+}
+
+void bench_platform(bench_context* ctx) {
+    mem_arena* arena = arena_create(MiB(64), KiB(64), ARENA_FLAG_NONE);
+
+    f64 single_thread_ns = 0.0;
+
+    u32 max_threads = MAX(4, plat_num_cpus());
+    for (u32 threads = 1; threads <= max_threads; threads *= 2) {
+        mem_arena_temp temp = arena_temp_begin(arena);
+
+        bench_jobs_arg* a = PUSH_STRUCT(arena, bench_jobs_arg);
+        a->jobs = plat_jobs_create(arena, threads);
+
+        // Per job overhead
+        string8 name = str8_pushf(arena, "plat_jobs/empty/%ut", threads);
+        bench_result* res = bench_run(ctx, name, (string8){ 0 }, bench_jobs_batch, a);
+        bench_set_unit(res, 1.0, "jobs");
+
+        // Scaling, checked against running the jobs on one thread
+        for (u32 i = 0; i < BENCH_JOBS_BATCH; i++) {
+            a->slots[i].work = 4096;
+        }
+
+        name = str8_pushf(arena, "plat_jobs/hash/%ut", threads);
+        res = bench_run(ctx, name, (string8){ 0 }, bench_jobs_batch, a);
+
+        if (res != NULL) {
+            bench_set_unit(res, 1.0, "jobs");
+
+            f64 mean = bench_mean(res);
+            if (threads == 1) {
+                single_thread_ns = mean;
+            } else if (single_thread_ns > 0.0) {
+                bench_add_metric(res, "speedup", single_thread_ns / mean);
+            }
+
+            bench_jobs_batch(a, BENCH_JOBS_BATCH);
+
+            u32 wrong_results = 0;
+            for (u32 i = 0; i < BENCH_JOBS_BATCH; i++) {
+                wrong_results += a->slots[i].result != bench_hash(i, a->slots[i].work);
+            }
+            bench_add_metric(res, "wrong_results", wrong_results);
+        }
+
+        // Nested jobs, plus more jobs than fit in a deque
+        bench_jobs_stress_arg stress = { .jobs = a->jobs };
+        mem_scratch_mark mark = arena_scratch_mark();
+
+        name = str8_pushf(arena, "plat_jobs/stress/%ut", threads);
+        res = bench_run(ctx, name, (string8){ 0 }, bench_jobs_stress, &stress);
+
+        if (res != NULL) {
+            bench_set_unit(res, (f64)(((u64)2 << BENCH_JOBS_TREE_DEPTH) - 1), "jobs");
+
+            u64 num_jobs = 3 * PLAT_JOBS_DEQUE_SIZE;
+            u64 num_done = 0;
+            plat_job_counter counter = { 0 };
+
+            for (u64 i = 0; i < num_jobs; i++) {
+                plat_jobs_submit(a->jobs, bench_job_increment, &num_done, &counter);
+            }
+            plat_jobs_wait(a->jobs, &counter);
+
+            stress.lost_jobs += num_jobs - ATOMIC_LOAD_U64(&num_done);
+
+            mem_scratch_mark end_mark = arena_scratch_mark();
+            b32 scratch_leaked = memcmp(&mark, &end_mark, sizeof(mark)) != 0;
+
+            bench_add_metric(res, "lost_jobs", (f64)stress.lost_jobs);
+            bench_add_metric(res, "scratch_leaked", scratch_leaked);
+        }
+
+        plat_jobs_destroy(a->jobs);
+
+        arena_temp_end(temp);
+    }
+
+    arena_destroy(arena);
+}
+
+// Truetype
+
+typedef struct {
+    mem_arena* arena;
+    string8 file;
+    tt_font_info* info;
+    tt_validation_level validation;
+
+    // Glyphs used for rendering
+    u32 num_glyphs;
+    tt_glyph_data* glyphs;
+
+    // Sdf and coverage
+    f32 scale;
+    u32 padding;
+    f32 range;
+    tt_sdf_mode mode;
+    // `tt_sdf_flag`s, only used by the exact mode
+    u32 flags;
+    // NULL renders on the calling thread
+    plat_job_system* jobs;
+    bitmap_r8* bitmaps;
+} bench_font_arg;
+
+void bench_font_init(void* arg, u64 num_ops) {
+    bench_font_arg* a = (bench_font_arg*)arg;
+
+    for (u64 i = 0; i < num_ops; i++) {
+        tt_font_info info = { 0 };
+        tt_font_init(a->file, &info, a->validation);
+    }
+}
+
+void bench_be32_sum(void* arg, u64 num_ops) {
+    bench_font_arg* a = (bench_font_arg*)arg;
+
+    volatile u32 sum = 0;
+    for (u64 i = 0; i < num_ops; i++) {
+        sum += be32_sum(a->file.str, a->file.size / 4);
+    }
+}
+
+void bench_glyph_index(void* arg, u64 num_ops) {
+    bench_font_arg* a = (bench_font_arg*)arg;
+
+    volatile u32 sum = 0;
+    for (u64 i = 0; i < num_ops; i++) {
+        sum += tt_glyph_index(a->file, a->info, (u32)(i & 0xffff));
+    }
+}
+
+void bench_glyph_data(void* arg, u64 num_ops) {
+    bench_font_arg* a = (bench_font_arg*)arg;
+
+    for (u64 i = 0; i < num_ops; i++) {
+        mem_arena_temp temp = arena_temp_begin(a->arena);
+
+        tt_glyph_data_from_index(a->arena, a->file, a->info, (u32)(i % a->info->num_glyphs));
+
+        arena_temp_end(temp);
+    }
+}
+
+void bench_sdf(void* arg, u64 num_ops) {
+    bench_font_arg* a = (bench_font_arg*)arg;
+
+    for (u64 i = 0; i < num_ops; i++) {
+        u32 g = (u32)(i % a->num_glyphs);
+
+        if (a->mode == TT_SDF_MODE_FAST) {
+            tt_render_glyph_sdf_fast(
+                &a->bitmaps[g], (v2_i32){ 0, 0 }, &a->glyphs[g],
+                a->scale, a->padding, a->range
+            );
+        } else if (a->flags != TT_SDF_FLAG_NONE) {
+            // Flags are only exposed through jobs
+            tt_sdf_job job = {
+                .bmp = &a->bitmaps[g],
+                .glyph = &a->glyphs[g],
+                .scale = a->scale,
+                .padding = a->padding,
+                .dist_px_range = a->range,
+                .flags = a->flags,
+            };
+
+            tt_render_glyphs_sdf(a->jobs, &job, 1);
+        } else {
+            tt_render_glyph_sdf(
+                a->jobs, &a->bitmaps[g], (v2_i32){ 0, 0 }, &a->glyphs[g],
+                a->scale, a->padding, a->range
+            );
+        }
+    }
+}
+
+void bench_sdf_batch(void* arg, u64 num_ops) {
+    bench_font_arg* a = (bench_font_arg*)arg;
+
+    mem_arena_temp scratch = arena_scratch_get(&a->arena, 1);
+
+    tt_sdf_job* sdf_jobs = PUSH_ARRAY_NZ(scratch.arena, tt_sdf_job, num_ops);
+    for (u64 i = 0; i < num_ops; i++) {
+        u32 g = (u32)(i % a->num_glyphs);
+
+        sdf_jobs[i] = (tt_sdf_job){
+            .bmp = &a->bitmaps[g],
+            .glyph = &a->glyphs[g],
+            .scale = a->scale,
+            .padding = a->padding,
+            .dist_px_range = a->range,
+            .mode = a->mode,
+            .flags = a->flags,
+        };
+    }
+
+    // Jobs sharing a bitmap would race, so they are run in groups
+    // of at most one job per glyph
+    for (u64 i = 0; i < num_ops; i += a->num_glyphs) {
+        u32 count = (u32)MIN(a->num_glyphs, num_ops - i);
+        tt_render_glyphs_sdf(a->jobs, sdf_jobs + i, count);
+    }
+
+    arena_scratch_release(scratch);
+}
+
+void bench_coverage(void* arg, u64 num_ops) {
+    bench_font_arg* a = (bench_font_arg*)arg;
+
+    for (u64 i = 0; i < num_ops; i++) {
+        u32 g = (u32)(i % a->num_glyphs);
+
+        tt_render_glyph_coverage(&a->bitmaps[g], (v2_i32){ 0, 0 }, &a->glyphs[g], a->scale);
+    }
+}
+
+// Renders every glyph once into `out`, which has one bitmap per glyph
+void bench_sdf_render_all(bench_font_arg* a, bitmap_r8* out) {
+    bitmap_r8* bitmaps = a->bitmaps;
+    a->bitmaps = out;
+
+    for (u32 g = 0; g < a->num_glyphs; g++) {
+        memset(out[g].data, 0, (u64)out[g].width * out[g].height);
+    }
+
+    bench_sdf(a, a->num_glyphs);
+
+    a->bitmaps = bitmaps;
+}
+
+// Max and mean absolute difference between two sets of bitmaps
+void bench_bitmaps_diff(
+    const bitmap_r8* a, const bitmap_r8* b, u32 count, f64* max_diff, f64* mean_diff
+) {
+    u64 sum = 0;
+    u64 num = 0;
+    u32 max = 0;
+
+    for (u32 g = 0; g < count; g++) {
+        u64 size = (u64)a[g].width * a[g].height;
+
+        for (u64 i = 0; i < size; i++) {
+            u32 d = (u32)ABS((i32)a[g].data[i] - (i32)b[g].data[i]);
+            max = MAX(max, d);
+            sum += d;
+        }
+
+        num += size;
+    }
+
+    *max_diff = (f64)max;
+    *mean_diff = num ? (f64)sum / (f64)num : 0.0;
+}
+
+// One bitmap per glyph, each big enough for any of the glyphs
+bitmap_r8* bench_bitmaps(bench_font_arg* a, mem_arena* arena) {
+    i32 max_extent = 0;
+    for (u32 g = 0; g < a->num_glyphs; g++) {
+        const tt_glyph_data* glyph = &a->glyphs[g];
+        max_extent = MAX(max_extent, glyph->x_max - glyph->x_min);
+        max_extent = MAX(max_extent, glyph->y_max - glyph->y_min);
+    }
+
+    u32 size = (u32)ceilf((f32)max_extent * a->scale) + a->padding * 2 + 2;
+
+    bitmap_r8* bitmaps = PUSH_ARRAY(arena, bitmap_r8, a->num_glyphs);
+
+    for (u32 g = 0; g < a->num_glyphs; g++) {
+        bitmaps[g] = (bitmap_r8){
+            .width = size,
+            .height = size,
+            .data = PUSH_ARRAY(arena, u8, (u64)size * size),
+        };
+    }
+
+    return bitmaps;
+}
+
+// Total pixels of one bitmap, used as the throughput unit
+f64 bench_bitmap_pixels(const bench_font_arg* a) {
+    return (f64)a->bitmaps[0].width * (f64)a->bitmaps[0].height;
+}
+
+void _bench_font(bench_context* ctx, mem_arena* arena, string8 path, string8 file) {
+    tt_font_info* info = PUSH_STRUCT(arena, tt_font_info);
+    tt_font_init(file, info, TT_VALIDATION_FULL);
+    if (!info->initialized) {
+        error_emitf("Failed to parse font %.*s", STR8_FMT(path));
+        return;
+    }
+
+    bench_font_arg base = {
+        .arena = arena,
+        .file = file,
+        .info = info,
+    };
+
+    // Checksum kernel of every level the CPU has, over the whole file
+    {
+        static const struct { simd_level level; const char* name; } levels[] = {
+            { SIMD_LEVEL_SCALAR, "be32_sum/scalar" },
+            { SIMD_LEVEL_SSE2, "be32_sum/sse2" },
+            { SIMD_LEVEL_AVX2, "be32_sum/avx2" },
+            { SIMD_LEVEL_NEON, "be32_sum/neon" },
+        };
+
+        simd_level level = simd_get_level();
+
+        simd_set_level(SIMD_LEVEL_SCALAR);
+        u32 scalar_sum = be32_sum(file.str, file.size / 4);
+
+        for (u32 i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+            simd_set_level(levels[i].level);
+            if (simd_get_level() != levels[i].level) { continue; }
+
+            string8 name = str8_from_cstr((u8*)levels[i].name);
+            bench_result* res = bench_run(ctx, name, path, bench_be32_sum, &base);
+            bench_set_unit(res, (f64)(file.size / 4 * 4), "B");
+
+            u32 sum = be32_sum(file.str, file.size / 4);
+            bench_add_metric(res, "wrong_sum", sum != scalar_sum);
+        }
+
+        simd_set_level(level);
+    }
+
+    base.validation = TT_VALIDATION_FULL;
+    bench_result* res = bench_run(ctx, STR8_LIT("tt_font_init/full"), path, bench_font_init, &base);
+    bench_set_unit(res, (f64)file.size, "B");
+
+    base.validation = TT_VALIDATION_LAZY;
+    res = bench_run(ctx, STR8_LIT("tt_font_init/lazy"), path, bench_font_init, &base);
+    bench_set_unit(res, (f64)file.size, "B");
+
+    bench_run(ctx, STR8_LIT("tt_glyph_index"), path, bench_glyph_index, &base);
+
+    res = bench_run(ctx, STR8_LIT("tt_glyph_data_from_index"), path, bench_glyph_data, &base);
+    bench_set_unit(res, 1.0, "glyphs");
+
+    // Everything past this uses the lookup tables, like the app does
+    tt_font_build_cmap_table(arena, file, info);
+    tt_font_build_component_cache(arena, file, info);
+
+    bench_run(ctx, STR8_LIT("tt_glyph_index/cmap_table"), path, bench_glyph_index, &base);
+
+    res = bench_run(ctx, STR8_LIT("tt_glyph_data_from_index/component_cache"), path, bench_glyph_data, &base);
+    bench_set_unit(res, 1.0, "glyphs");
+
+    // Rendering uses the printable ASCII glyphs
+    base.glyphs = PUSH_ARRAY(arena, tt_glyph_data, 94);
+    for (u32 c = 33; c < 127; c++) {
+        u32 index = tt_glyph_index(file, info, c);
+        if (index == 0) { continue; }
+
+        base.glyphs[base.num_glyphs] = tt_glyph_data_from_index(arena, file, info, index);
+        tt_glyph_color_edges(&base.glyphs[base.num_glyphs]);
+        base.num_glyphs++;
+    }
+
+    if (base.num_glyphs == 0) { return; }
+
+    static const f32 sdf_sizes[] = { 16.0f, 32.0f, 64.0f, 128.0f };
+
+    for (u32 i = 0; i < sizeof(sdf_sizes) / sizeof(sdf_sizes[0]); i++) {
+        mem_arena_temp temp = arena_temp_begin(arena);
+
+        bench_font_arg a = base;
+        a.scale = tt_scale_for_em(file, info, sdf_sizes[i]);
+        a.padding = (u32)(sdf_sizes[i] / 8.0f);
+        a.range = (f32)a.padding;
+        a.bitmaps = bench_bitmaps(&a, arena);
+
+        string8 name = str8_pushf(arena, "tt_render_glyph_sdf/%upx", (u32)sdf_sizes[i]);
+        res = bench_run(ctx, name, path, bench_sdf, &a);
+        bench_set_unit(res, bench_bitmap_pixels(&a), "px");
+
+        // The SIMD kernels are checked against the scalar path
+        // whenever the CPU has them
+        simd_level level = simd_get_level();
+        if (res != NULL && level != SIMD_LEVEL_SCALAR) {
+            bitmap_r8* simd_bitmaps = bench_bitmaps(&a, arena);
+            bitmap_r8* scalar_bitmaps = bench_bitmaps(&a, arena);
+
+            bench_sdf_render_all(&a, simd_bitmaps);
+
+            simd_set_level(SIMD_LEVEL_SCALAR);
+            bench_sdf_render_all(&a, scalar_bitmaps);
+
+            name = str8_pushf(arena, "tt_render_glyph_sdf/%upx/scalar", (u32)sdf_sizes[i]);
+            bench_result* scalar_res = bench_run(ctx, name, path, bench_sdf, &a);
+            bench_set_unit(scalar_res, bench_bitmap_pixels(&a), "px");
+
+            simd_set_level(level);
+
+            f64 max_diff = 0.0, mean_diff = 0.0;
+            bench_bitmaps_diff(simd_bitmaps, scalar_bitmaps, a.num_glyphs, &max_diff, &mean_diff);
+
+            bench_add_metric(res, "scalar_max_diff", max_diff);
+            bench_add_metric(res, "scalar_mean_diff", mean_diff);
+        }
+
+        // The grid is checked and timed against testing every segment
+        a.flags = TT_SDF_FLAG_BRUTE_FORCE;
+        name = str8_pushf(arena, "tt_render_glyph_sdf/%upx/brute_force", (u32)sdf_sizes[i]);
+        bench_result* brute_res = bench_run(ctx, name, path, bench_sdf, &a);
+
+        if (brute_res != NULL) {
+            bench_set_unit(brute_res, bench_bitmap_pixels(&a), "px");
+
+            bitmap_r8* brute_bitmaps = bench_bitmaps(&a, arena);
+            bitmap_r8* grid_bitmaps = bench_bitmaps(&a, arena);
+
+            bench_sdf_render_all(&a, brute_bitmaps);
+            a.flags = TT_SDF_FLAG_NONE;
+            bench_sdf_render_all(&a, grid_bitmaps);
+
+            f64 max_diff = 0.0, mean_diff = 0.0;
+            bench_bitmaps_diff(grid_bitmaps, brute_bitmaps, a.num_glyphs, &max_diff, &mean_diff);
+
+            bench_add_metric(brute_res, "grid_max_diff", max_diff);
+            bench_add_metric(brute_res, "grid_mean_diff", mean_diff);
+
+            if (res != NULL) {
+                bench_add_metric(brute_res, "grid_speedup", bench_mean(brute_res) / bench_mean(res));
+            }
+        }
+
+        a.flags = TT_SDF_FLAG_NONE;
+
+        // Error of the fast mode against the exact one
+        a.mode = TT_SDF_MODE_FAST;
+        name = str8_pushf(arena, "tt_render_glyph_sdf_fast/%upx", (u32)sdf_sizes[i]);
+        res = bench_run(ctx, name, path, bench_sdf, &a);
+
+        if (res != NULL) {
+            bench_set_unit(res, bench_bitmap_pixels(&a), "px");
+
+            bitmap_r8* fast_bitmaps = bench_bitmaps(&a, arena);
+            bitmap_r8* exact_bitmaps = bench_bitmaps(&a, arena);
+
+            bench_sdf_render_all(&a, fast_bitmaps);
+            a.mode = TT_SDF_MODE_EXACT;
+            bench_sdf_render_all(&a, exact_bitmaps);
+
+            f64 max_diff = 0.0, mean_diff = 0.0;
+            bench_bitmaps_diff(fast_bitmaps, exact_bitmaps, a.num_glyphs, &max_diff, &mean_diff);
+
+            bench_add_metric(res, "exact_max_diff", max_diff);
+            bench_add_metric(res, "exact_mean_diff", mean_diff);
+        }
+
+        arena_temp_end(temp);
+    }
+
+    // Thread scaling of single glyphs and batches, checked against one thread
+    {
+        mem_arena_temp temp = arena_temp_begin(arena);
+
+        bench_font_arg a = base;
+        a.scale = tt_scale_for_em(file, info, 64.0f);
+        a.padding = 8;
+        a.range = 8.0f;
+        a.bitmaps = bench_bitmaps(&a, arena);
+
+        bitmap_r8* single_bitmaps = bench_bitmaps(&a, arena);
+        bench_sdf_render_all(&a, single_bitmaps);
+
+        u32 max_threads = MAX(4, plat_num_cpus());
+        for (u32 threads = 1; threads <= max_threads; threads *= 2) {
+            static const struct { const char* name; bench_func* func; } variants[] = {
+                { "tt_render_glyph_sdf/64px/%ut", bench_sdf },
+                { "tt_render_glyphs_sdf/64px/%ut", bench_sdf_batch },
+            };
+
+            for (u32 j = 0; j < sizeof(variants) / sizeof(variants[0]); j++) {
+                string8 name = str8_pushf(arena, variants[j].name, threads);
+                if (!bench_enabled(ctx, name)) { continue; }
+
+                a.jobs = plat_jobs_create(arena, threads);
+
+                res = bench_run(ctx, name, path, variants[j].func, &a);
+                bench_set_unit(res, bench_bitmap_pixels(&a), "px");
+
+                // Samples can be shorter than one pass over the glyphs
+                variants[j].func(&a, a.num_glyphs);
+
+                f64 max_diff = 0.0, mean_diff = 0.0;
+                bench_bitmaps_diff(a.bitmaps, single_bitmaps, a.num_glyphs, &max_diff, &mean_diff);
+                bench_add_metric(res, "single_max_diff", max_diff);
+
+                plat_jobs_destroy(a.jobs);
+                a.jobs = NULL;
+            }
+        }
+
+        arena_temp_end(temp);
+    }
+
+    static const f32 coverage_sizes[] = { 12.0f, 24.0f, 48.0f };
+
+    for (u32 i = 0; i < sizeof(coverage_sizes) / sizeof(coverage_sizes[0]); i++) {
+        mem_arena_temp temp = arena_temp_begin(arena);
+
+        bench_font_arg a = base;
+        a.scale = tt_scale_for_em(file, info, coverage_sizes[i]);
+        a.bitmaps = bench_bitmaps(&a, arena);
+
+        string8 name = str8_pushf(arena, "tt_render_glyph_coverage/%upx", (u32)coverage_sizes[i]);
+        res = bench_run(ctx, name, path, bench_coverage, &a);
+        bench_set_unit(res, 1.0, "glyphs");
+
+        arena_temp_end(temp);
+    }
+}
+
+void bench_font(bench_context* ctx, string8 path) {
+    string8 file = plat_file_map(path);
+    if (file.size == 0) {
+        error_emitf("Failed to open font %.*s", STR8_FMT(path));
+        return;
+    }
+
+    // Kept apart from the results, which outlive every font
+    mem_arena* arena = arena_create(GiB(4), MiB(1), ARENA_FLAG_GROWABLE);
+    arena_set_name(arena, "font");
+
+    _bench_font(ctx, arena, path, file);
+
+#ifdef ARENA_TELEMETRY
+    // The font's arena is gone by the final report
+    mem_arena_stats stats = arena_get_stats(arena);
+    printf(
+        "font arena: peak %" PRIu64 " bytes, %u blocks, %" PRIu64 " pushes\n",
+        stats.peak_pos, stats.peak_blocks, stats.num_pushes
+    );
+#endif
+
+    arena_destroy(arena);
+    plat_file_unmap(file);
+}
+
+// Glyph atlas
+
+// Distinct glyphs looked up, many more than fit in the atlas
+#define BENCH_ATLAS_GLYPHS 4096
+// Glyphs looked up most of the time, like the text on screen
+#define BENCH_ATLAS_HOT_GLYPHS 256
+// Lookups in each frame
+#define BENCH_ATLAS_FRAME_OPS 64
+// Max width and height of the glyphs
+#define BENCH_ATLAS_MAX_SIZE 40
+
+typedef struct {
+    tt_atlas* atlas;
+    prng rng;
+
+    // Byte `i` is `(u8)i`, and glyph `g` is copied from `pattern + (g & 0xff)`,
+    // so every pixel can be checked once it is in the atlas
+    u8* pattern;
+
+    u64 num_lookups;
+    u64 num_inserts;
+} bench_atlas_arg;
+
+// Sizes are fixed for each glyph index, and one glyph in 64 is empty
+void bench_atlas_glyph_size(u32 glyph_index, u32* width, u32* height) {
+    if (glyph_index % 64 == 0) {
+        *width = 0;
+        *height = 0;
+        return;
+    }
+
+    u32 h = glyph_index * 0x9e3779b1u;
+    *width = 4 + (h >> 8) % (BENCH_ATLAS_MAX_SIZE - 3);
+    *height = 4 + (h >> 20) % (BENCH_ATLAS_MAX_SIZE - 3);
+}
+
+tt_atlas_entry* bench_atlas_insert(bench_atlas_arg* a, u32 glyph_index, u32 variant) {
+    u32 width = 0, height = 0;
+    bench_atlas_glyph_size(glyph_index, &width, &height);
+
+    const u8* pixels = width ? a->pattern + (glyph_index & 0xff) : NULL;
+    tt_atlas_entry* entry = tt_atlas_insert(
+        a->atlas, NULL, glyph_index, variant, pixels, width, height
+    );
+
+    if (entry != NULL) {
+        a->num_inserts++;
+    }
+
+    return entry;
+}
+
+// Looks up a glyph, and inserts it on a miss
+void bench_atlas_lookup(void* arg, u64 num_ops) {
+    bench_atlas_arg* a = (bench_atlas_arg*)arg;
+
+    for (u64 i = 0; i < num_ops; i++) {
+        if (a->num_lookups++ % BENCH_ATLAS_FRAME_OPS == 0) {
+            tt_atlas_frame_begin(a->atlas);
+        }
+
+        u32 r = prng_rand_r(&a->rng);
+        u32 glyph_index = (r & 7) ?
+            (r >> 3) % BENCH_ATLAS_HOT_GLYPHS :
+            (r >> 3) % BENCH_ATLAS_GLYPHS;
+
+        if (tt_atlas_find(a->atlas, NULL, glyph_index, 0) == NULL) {
+            bench_atlas_insert(a, glyph_index, 0);
+        }
+    }
+}
+
+tt_atlas_rect bench_atlas_slot(const tt_atlas* atlas, const tt_atlas_entry* entry) {
+    if (entry->rect.width == 0 || entry->rect.height == 0) {
+        return (tt_atlas_rect){ 0 };
+    }
+
+    return (tt_atlas_rect){
+        entry->rect.x, entry->rect.y,
+        entry->rect.width + atlas->padding, entry->rect.height + atlas->padding,
+    };
+}
+
+b32 bench_atlas_rect_contains(tt_atlas_rect outer, tt_atlas_rect inner) {
+    return inner.x >= outer.x && inner.y >= outer.y &&
+        inner.x + inner.width <= outer.x + outer.width &&
+        inner.y + inner.height <= outer.y + outer.height;
+}
+
+// Checks the packing, pixels, dirty rects and stats of the atlas
+// after the lookups, and adds the number of errors of each as metrics
+void bench_atlas_check(bench_atlas_arg* a, bench_result* res) {
+    tt_atlas* atlas = a->atlas;
+    u32 page_width = atlas->page_width;
+
+    u32 slot_overlaps = 0;
+    u32 skyline_errors = 0;
+    u32 dirty_errors = 0;
+    u32 pixel_errors = 0;
+    u32 stats_errors = 0;
+
+    // A new frame of glyphs that are not in the atlas yet,
+    // which must each end up in one of the dirty rects
+    tt_atlas_frame_begin(atlas);
+
+    u32 num_fresh = 0;
+    tt_atlas_entry fresh[32];
+
+    for (u32 i = 0; i < 32; i++) {
+        tt_atlas_entry* entry = bench_atlas_insert(a, 1 + i * 61, 1);
+        if (entry != NULL) {
+            fresh[num_fresh++] = *entry;
+        }
+    }
+
+    mem_arena_temp scratch = arena_scratch_get(NULL, 0);
+
+    u32 num_glyphs = 0;
+    u64 used_pixels = 0;
+
+    for (u32 p = 0; p < atlas->num_pages; p++) {
+        const tt_atlas_page* page = &atlas->pages[p];
+
+        tt_atlas_rect* slots = PUSH_ARRAY_NZ(scratch.arena, tt_atlas_rect, page->num_entries);
+        u32 num_slots = 0;
+
+        for (const tt_atlas_entry* entry = page->entries; entry != NULL; entry = entry->next) {
+            num_glyphs++;
+
+            tt_atlas_rect slot = bench_atlas_slot(atlas, entry);
+            if (slot.width == 0) { continue; }
+
+            used_pixels += (u64)slot.width * slot.height;
+
+            for (u32 i = 0; i < num_slots; i++) {
+                slot_overlaps += (u32)_tt_atlas_rect_overlaps(slot, slots[i]);
+            }
+            slots[num_slots++] = slot;
+
+            // Slots are under the skyline, and inside the page
+            skyline_errors += slot.x + slot.width > page_width ||
+                slot.y + slot.height > atlas->page_height;
+
+            for (u32 i = 0; i < page->num_nodes; i++) {
+                const _tt_atlas_skyline_node* node = &page->nodes[i];
+
+                if (
+                    node->x < slot.x + slot.width && slot.x < node->x + node->width &&
+                    slot.y + slot.height > node->y
+                ) {
+                    skyline_errors++;
+                }
+            }
+
+            // Glyph pixels come from the pattern, and the padding is cleared
+            const u8* src = a->pattern + (entry->glyph_index & 0xff);
+
+            for (u32 y = 0; y < slot.height; y++) {
+                const u8* row = page->data + (u64)(slot.y + y) * page_width + slot.x;
+
+                for (u32 x = 0; x < slot.width; x++) {
+                    b32 in_glyph = x < entry->rect.width && y < entry->rect.height;
+                    u8 expected = in_glyph ? src[y * entry->rect.width + x] : 0;
+
+                    pixel_errors += row[x] != expected;
+                }
+            }
+        }
+
+        // Nodes are sorted and cover the width of the page
+        u32 x = 0;
+        for (u32 i = 0; i < page->num_nodes; i++) {
+            const _tt_atlas_skyline_node* node = &page->nodes[i];
+
+            skyline_errors += node->x != x || node->width == 0 || node->y > atlas->page_height;
+            x = node->x + node->width;
+        }
+        skyline_errors += x != page_width;
+
+        for (u32 i = 0; i < page->num_dirty_rects; i++) {
+            for (u32 j = 0; j < i; j++) {
+                dirty_errors += (u32)_tt_atlas_rect_overlaps(page->dirty_rects[i], page->dirty_rects[j]);
+            }
+        }
+    }
+
+    for (u32 i = 0; i < num_fresh; i++) {
+        tt_atlas_rect slot = bench_atlas_slot(atlas, &fresh[i]);
+        if (slot.width == 0) { continue; }
+
+        u32 num_rects = 0;
+        const tt_atlas_rect* rects = tt_atlas_dirty_rects(atlas, fresh[i].page, &num_rects);
+
+        b32 covered = false;
+        for (u32 j = 0; j < num_rects; j++) {
+            covered |= bench_atlas_rect_contains(rects[j], slot);
+        }
+
+        dirty_errors += !covered;
+    }
+
+    arena_scratch_release(scratch);
+
+    tt_atlas_stats stats = tt_atlas_get_stats(atlas);
+
+    stats_errors += stats.num_glyphs != num_glyphs;
+    stats_errors += stats.used_pixels != used_pixels;
+    stats_errors += stats.hits + stats.misses != a->num_lookups;
+    stats_errors += a->num_inserts - stats.evicted_glyphs != num_glyphs;
+
+    f64 occupancy = stats.total_pixels ? (f64)used_pixels / (f64)stats.total_pixels : 0.0;
+    stats_errors += fabs((f64)stats.occupancy - occupancy) > 1e-6;
+
+    bench_add_metric(res, "slot_overlaps", slot_overlaps);
+    bench_add_metric(res, "skyline_errors", skyline_errors);
+    bench_add_metric(res, "dirty_rect_errors", dirty_errors);
+    bench_add_metric(res, "pixel_errors", pixel_errors);
+    bench_add_metric(res, "stats_errors", stats_errors);
+    bench_add_metric(res, "occupancy", stats.occupancy);
+    bench_add_metric(res, "hit_rate", (f64)stats.hits / (f64)MAX(1, a->num_lookups));
+    bench_add_metric(res, "evicted_pages", (f64)stats.evicted_pages);
+}
+
+void bench_atlas(bench_context* ctx) {
+    mem_arena* arena = arena_create(MiB(16), KiB(64), ARENA_FLAG_NONE);
+
+    // Small pages, so the working set spills and pages get evicted
+    bench_atlas_arg a = {
+        .atlas = tt_atlas_create(arena, TT_ATLAS_FORMAT_R8, 256, 256, 4, 1, 1024),
+        .pattern = PUSH_ARRAY_NZ(arena, u8, 256 + BENCH_ATLAS_MAX_SIZE * BENCH_ATLAS_MAX_SIZE),
+    };
+
+    prng_seed_r(&a.rng, 0x853c49e6748fea9bull, 0xda3e39cb94b95bdbull);
+
+    for (u32 i = 0; i < 256 + BENCH_ATLAS_MAX_SIZE * BENCH_ATLAS_MAX_SIZE; i++) {
+        a.pattern[i] = (u8)i;
+    }
+
+    bench_result* res = bench_run(ctx, STR8_LIT("tt_atlas_lookup"), (string8){ 0 }, bench_atlas_lookup, &a);
+    if (res != NULL) {
+        bench_atlas_check(&a, res);
+    }
+
+    arena_destroy(arena);
+}
+
+void bench_base(bench_context* ctx) {
+    mem_arena* arena = arena_create(MiB(64), KiB(64), ARENA_FLAG_NONE);
+
+    static const u64 sizes[] = { 64, KiB(4), KiB(256) };
+
+    for (u32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench_arena_arg a = { arena, sizes[i] };
+
+        string8 name = str8_pushf(ctx->arena, "arena_push_pop/%llu", (unsigned long long)sizes[i]);
+        bench_result* res = bench_run(ctx, name, (string8){ 0 }, bench_arena_push_pop, &a);
+        bench_set_unit(res, (f64)sizes[i], "B");
+    }
+
+    {
+        mem_arena* spill_arena = arena_create(KiB(64), KiB(64), ARENA_FLAG_GROWABLE);
+
+        for (u32 cached = 0; cached < 2; cached++) {
+            arena_block_cache_set_size(cached ? ARENA_BLOCK_CACHE_SIZE : 0);
+
+            string8 name = cached ? STR8_LIT("arena_spill/cached") : STR8_LIT("arena_spill/uncached");
+            bench_result* res = bench_run(ctx, name, (string8){ 0 }, bench_arena_spill, spill_arena);
+
+#ifdef ARENA_TELEMETRY
+            if (res != NULL) {
+                mem_arena_stats before = arena_get_stats(spill_arena);
+                bench_arena_spill(spill_arena, 1000);
+                mem_arena_stats after = arena_get_stats(spill_arena);
+
+                u32 syscalls = (after.num_reserves - before.num_reserves) +
+                    (after.num_releases - before.num_releases);
+                bench_add_metric(res, "block_syscalls_per_op", (f64)syscalls / 1000.0);
+            }
+#else
+            UNUSED(res);
+#endif
+        }
+
+        arena_destroy(spill_arena);
+    }
+
+    {
+        // Much larger than the TLB can cover with 4 KiB pages
+        u64 size = MiB(256);
+
+        static const struct { const char* name; u32 flags; } variants[] = {
+            { "arena_random_access/default", ARENA_FLAG_NONE },
+            { "arena_random_access/prefault", ARENA_FLAG_PREFAULT },
+            { "arena_random_access/huge_pages", ARENA_FLAG_HUGE_PAGES | ARENA_FLAG_PREFAULT },
+        };
+
+        for (u32 i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+            string8 name = str8_from_cstr((u8*)variants[i].name);
+            // Skipped before the arena is created and faulted in
+            if (!bench_enabled(ctx, name)) { continue; }
+
+            mem_arena* big_arena = arena_create(size + MiB(2), size, variants[i].flags);
+
+            bench_random_access_arg a = {
+                .data = PUSH_ARRAY_NZ(big_arena, u64, size / sizeof(u64)),
+                .count = size / sizeof(u64),
+                .state = 0x9e3779b97f4a7c15ull,
+            };
+
+            // Without prefaulting, the first samples would be page faults
+            u64 fault_start = plat_time_nsec();
+            for (u64 j = 0; j < a.count; j += 512) { a.data[j] = j; }
+            f64 first_touch_ms = (f64)(plat_time_nsec() - fault_start) / 1e6;
+
+            bench_result* res = bench_run(ctx, name, (string8){ 0 }, bench_random_access, &a);
+            bench_add_metric(res, "first_touch_ms", first_touch_ms);
+
+            arena_destroy(big_arena);
+        }
+    }
+
+    bench_run(ctx, STR8_LIT("str8_pushf"), (string8){ 0 }, bench_str8_pushf, arena);
+
+    bench_run(ctx, STR8_LIT("prof_zone"), (string8){ 0 }, bench_prof_zone, NULL);
+
+    arena_destroy(arena);
+}
+
+void bench_json_str(mem_arena* arena, string8_list* list, string8 str) {
+    str8_list_add(arena, list, STR8_LIT("\""));
+
+    // Characters that need no escaping are added in runs
+    u64 run_start = 0;
+
+    for (u64 i = 0; i < str.size; i++) {
+        u8 c = str.str[i];
+        if (c != '"' && c != '\\' && c >= 0x20) { continue; }
+
+        if (i > run_start) {
+            str8_list_add(arena, list, str8_substr_size(str, run_start, i - run_start));
+        }
+        run_start = i + 1;
+
+        if (c < 0x20) {
+            str8_list_add(arena, list, str8_pushf(arena, "\\u%04x", c));
+        } else {
+            str8_list_add(arena, list, str8_pushf(arena, "\\%c", c));
+        }
+    }
+
+    if (str.size > run_start) {
+        str8_list_add(arena, list, str8_substr_size(str, run_start, str.size - run_start));
+    }
+
+    str8_list_add(arena, list, STR8_LIT("\""));
+}
+
+b32 bench_write_json(bench_context* ctx, string8 path) {
+    mem_arena* arena = ctx->arena;
+    string8_list list = { 0 };
+
+    str8_list_add(arena, &list, str8_pushf(
+        arena, "{\n  \"platform\": \"%.*s\",\n  \"simd_level\": %d,\n"
+        "  \"num_cpus\": %u,\n  \"results\": [",
+        STR8_FMT(plat_get_name()), (i32)simd_get_level(), plat_num_cpus()
+    ));
+
+    for (bench_result* res = ctx->first; res != NULL; res = res->next) {
+        f64 mean = bench_mean(res);
+
+        if (res != ctx->first) {
+            str8_list_add(arena, &list, STR8_LIT(","));
+        }
+        str8_list_add(arena, &list, STR8_LIT("\n    {"));
+
+        str8_list_add(arena, &list, STR8_LIT("\"name\": "));
+        bench_json_str(arena, &list, res->name);
+        str8_list_add(arena, &list, STR8_LIT(", \"font\": "));
+        bench_json_str(arena, &list, res->font);
+
+        str8_list_add(arena, &list, str8_pushf(
+            arena, ", \"ops_per_sample\": %llu, \"samples\": %u, \"ns_per_op\": %.3f, "
+            "\"min\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f, "
+            "\"ops_per_sec\": %.3f",
+            (unsigned long long)res->ops_per_sample, res->num_samples, mean,
+            res->sample_ns[0], bench_percentile(res, 0.5), bench_percentile(res, 0.9),
+            bench_percentile(res, 0.99), res->sample_ns[res->num_samples - 1],
+            1e9 / mean
+        ));
+
+        if (res->unit != NULL) {
+            str8_list_add(arena, &list, str8_pushf(
+                arena, ", \"throughput\": %.3f, \"unit\": \"%s/s\"",
+                res->units_per_op * 1e9 / mean, res->unit
+            ));
+        }
+
+        if (res->num_metrics) {
+            str8_list_add(arena, &list, STR8_LIT(", \"metrics\": {"));
+
+            for (u32 i = 0; i < res->num_metrics; i++) {
+                str8_list_add(arena, &list, str8_pushf(
+                    arena, "%s\"%s\": %.6g", i ? ", " : "",
+                    res->metric_names[i], res->metric_values[i]
+                ));
+            }
+
+            str8_list_add(arena, &list, STR8_LIT("}"));
+        }
+
+        str8_list_add(arena, &list, STR8_LIT("}"));
+    }
+
+    str8_list_add(arena, &list, STR8_LIT("\n  ]\n}\n"));
+
+    return plat_file_write(path, &list, false);
+}
+
+int main(int argc, char** argv) {
+    log_frame_begin();
+
+    plat_init();
+    prof_init();
+
+    bench_context ctx = {
+        .arena = arena_create(GiB(4), MiB(1), ARENA_FLAG_GROWABLE),
+    };
+    arena_set_name(ctx.arena, "results");
+
+    string8 json_path = { 0 };
+    string8 trace_path = { 0 };
+    string8_list fonts = { 0 };
+
+    for (i32 i = 1; i < argc; i++) {
+        string8 arg = str8_from_cstr((u8*)argv[i]);
+
+        if (str8_equals(arg, STR8_LIT("--json")) && i + 1 < argc) {
+            json_path = str8_from_cstr((u8*)argv[++i]);
+        } else if (str8_equals(arg, STR8_LIT("--trace")) && i + 1 < argc) {
+            trace_path = str8_from_cstr((u8*)argv[++i]);
+        } else if (str8_equals(arg, STR8_LIT("--filter")) && i + 1 < argc) {
+            ctx.filter = str8_from_cstr((u8*)argv[++i]);
+        } else {
+            str8_list_add(ctx.arena, &fonts, arg);
+        }
+    }
+
+    if (fonts.count == 0) {
+        printf(
+            "Usage: %s [--json <file>] [--trace <file>] [--filter <text>] <fonts...>\n",
+            argv[0]
+        );
+        return 1;
+    }
+
+    bench_base(&ctx);
+    bench_platform(&ctx);
+    bench_atlas(&ctx);
+
+    for (string8_node* node = fonts.first; node != NULL; node = node->next) {
+        bench_font(&ctx, node->str);
+    }
+
+    if (json_path.size && !bench_write_json(&ctx, json_path)) {
+        error_emitf("Failed to write %.*s", STR8_FMT(json_path));
+    }
+
+    if (trace_path.size) {
+        string8_list trace = prof_trace_json(ctx.arena);
+
+        if (!plat_file_write(trace_path, &trace, false)) {
+            error_emitf("Failed to write %.*s", STR8_FMT(trace_path));
+        }
+    }
+
+#ifdef ARENA_TELEMETRY
+    arena_telemetry_report(stdout, 16);
+#endif
+
+    string8 err_str = log_frame_end(ctx.arena, LOG_ERROR, LOG_RES_CONCAT, true);
+
+    if (err_str.size) {
+        printf("\x1b[31m%.*s\x1b[0m\n", STR8_FMT(err_str));
+        return 1;
+    }
+
+    return 0;
+}
+
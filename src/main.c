@@ -24,8 +24,10 @@ void test_draw_glyph(
 );
 
 typedef struct {
+    // From font units to world space, applied in the shader
     v2_f32 translate;
     v2_f32 scale;
+    // Offset of the glyph's segments in the glyph cache's pool, in floats
     u32 data_offset;
     u32 num_segments;
     u32 num_points;
@@ -35,12 +37,18 @@ typedef struct {
 u32 num_glyphs = 0;
 v2_f32* vertex_data = NULL;
 instance* instance_data = NULL;
-u32 glyph_data_size = 0;
-u8* glyph_data = NULL;
+
+// `glyph_ssbo` mirrors the glyph cache's pool, so segments are only
+// uploaded when a glyph is added to the cache
+// Byte range of the pool that changed since the last upload
+u64 pool_dirty_start = ~(u64)0;
+u64 pool_dirty_end = 0;
+
+tt_glyph_cache* glyph_cache = NULL;
 
 void push_glyph(
     string8 file, tt_font_info* info,
-    u32 codepoint, v2_f32 translate, v2_f32 scale
+    u32 glyph_index, v2_f32 translate, v2_f32 scale
 );
 
 string8 test_vert_source;
@@ -57,19 +65,34 @@ v2_f32 unpack_point(u32 point_packed) {
 }
 
 int main(int argc, char** argv) {
-    UNUSED(argc);
-    UNUSED(argv);
-
     log_frame_begin();
 
+    // Pass `--trace <file>` to write the profiler's zones as a Chrome trace on exit
+    string8 trace_path = { 0 };
+    for (i32 i = 1; i < argc; i++) {
+        string8 arg = str8_from_cstr((u8*)argv[i]);
+
+        if (str8_equals(arg, STR8_LIT("--trace")) && i + 1 < argc) {
+            trace_path = str8_from_cstr((u8*)argv[++i]);
+        }
+    }
+
     plat_init();
+    prof_init();
 
     u64 seeds[2] = { 0 };
     plat_get_entropy(seeds, sizeof(seeds));
     prng_seed(seeds[0], seeds[1]);
 
-    mem_arena* perm_arena = arena_create(MiB(64), KiB(264), true);
-    mem_arena* frame_arena = arena_create(MiB(16), KiB(264), false);
+    // Faulted in as they are committed, so the frame loop
+    // does not take page faults on newly used memory
+    mem_arena* perm_arena = arena_create(
+        MiB(64), KiB(264),
+        ARENA_FLAG_GROWABLE | ARENA_FLAG_HUGE_PAGES | ARENA_FLAG_PREFAULT
+    );
+    mem_arena* frame_arena = arena_create(MiB(16), KiB(264), ARENA_FLAG_PREFAULT);
+    arena_set_name(perm_arena, "perm");
+    arena_set_name(frame_arena, "frame");
 
     string8 fonts[] = {
         STR8_LIT("res/Symbola.ttf"),
@@ -87,12 +110,21 @@ int main(int argc, char** argv) {
     string8 font_files[NUM_FONTS] = { 0 };
     tt_font_info font_infos[NUM_FONTS] = { 0 };
 
+    glyph_cache = tt_glyph_cache_create(perm_arena, MiB(8), 4096);
+
     for (u32 i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++) {
         info_emitf("Parsing %.*s...", STR8_FMT(fonts[i]));
-        font_files[i] = plat_file_read(perm_arena, fonts[i]);
-        tt_font_init(font_files[i], &font_infos[i]);
+        font_files[i] = plat_file_map(fonts[i]);
+
+        PROF_BEGIN("tt_font_init");
+        tt_font_init(font_files[i], &font_infos[i], TT_VALIDATION_LAZY);
+        PROF_END();
     }
 
+    // The lookup tables are built the first time a font is on screen,
+    // so fonts that are never drawn are not read past their headers
+    b8 font_tables_built[NUM_FONTS] = { 0 };
+
     win_gfx_backend_init();
     window* win = win_create(perm_arena, 1280, 720, STR8_LIT("Octopus"));
     win_make_current(win);
@@ -105,8 +137,6 @@ int main(int argc, char** argv) {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    // Both in bytes
-    u32 glyph_capacity = KiB(512);
     u32 max_glyphs = 256 * NUM_FONTS;
 
     u32 vert_array, vert_buffer, instance_ssbo, glyph_ssbo;
@@ -118,13 +148,11 @@ int main(int argc, char** argv) {
 
     vert_buffer = glh_create_buffer(GL_ARRAY_BUFFER, sizeof(v2_f32) * 6 * max_glyphs, NULL, GL_DYNAMIC_DRAW);
     instance_ssbo = glh_create_buffer(GL_SHADER_STORAGE_BUFFER, sizeof(instance) * max_glyphs, NULL, GL_DYNAMIC_DRAW);
-    glyph_ssbo = glh_create_buffer(GL_SHADER_STORAGE_BUFFER, glyph_capacity, NULL, GL_DYNAMIC_DRAW);
+    glyph_ssbo = glh_create_buffer(GL_SHADER_STORAGE_BUFFER, glyph_cache->pool_size, NULL, GL_DYNAMIC_DRAW);
 
     num_glyphs = 0;
     vertex_data = PUSH_ARRAY(perm_arena, v2_f32, 6 * max_glyphs);
     instance_data = PUSH_ARRAY(perm_arena, instance, max_glyphs);
-    glyph_data_size = 0;
-    glyph_data = PUSH_ARRAY(perm_arena, u8, glyph_capacity);
 
     string8 frag_source = plat_file_read(perm_arena, STR8_LIT("test.glsl"));
 
@@ -171,7 +199,11 @@ int main(int argc, char** argv) {
     while ((win->flags & WIN_FLAG_SHOULD_CLOSE) == 0) {
         log_frame_begin();
 
+        PROF_BEGIN("frame");
+
+        PROF_BEGIN("win_process_events");
         win_process_events(win);
+        PROF_END();
 
         view.center.x += win->mouse_scroll.x * view.width * 0.04f;
         view.center.y -= win->mouse_scroll.y * view.width * 0.04f;
@@ -208,19 +240,61 @@ int main(int argc, char** argv) {
 
 #if 1
         num_glyphs = 0;
-        glyph_data_size = 0;
+
+        PROF_BEGIN("push_glyphs");
 
         u32 rows = 6;
         u32 cols = 16;
+
+        // World space y is down, like the screen
+        f32 view_top = screen_to_world(win, &view, (v2_f32){ 0, 0 }).y;
+        f32 view_bottom = screen_to_world(win, &view, (v2_f32){ 0, (f32)win->height }).y;
+
         for (u32 i = 0; i < NUM_FONTS; i++) {
             f32 font_offset = 160 * (f32)(rows + 1) * (f32)i;
 
+            // The name line reaches up a glyph height above `font_offset`
+            f32 font_top = font_offset - 150.0f;
+            f32 font_bottom = font_offset + 150.0f * (f32)(rows + 1);
+            if (font_bottom < view_top || font_top > view_bottom) { continue; }
+
+            if (!font_tables_built[i]) {
+                PROF_BEGIN("build_font_tables");
+
+                tt_font_build_cmap_table(perm_arena, font_files[i], &font_infos[i]);
+                tt_font_build_component_cache(perm_arena, font_files[i], &font_infos[i]);
+                tt_font_build_hmetrics_table(perm_arena, font_files[i], &font_infos[i]);
+                tt_font_build_kern_table(perm_arena, font_files[i], &font_infos[i]);
+
+                PROF_END();
+
+                font_tables_built[i] = true;
+            }
+
+            // Same scale as `push_glyph`
+            f32 units_per_em = (f32)font_infos[i].units_per_em;
+            f32 pen_x = 0.0f;
+
+            // Each glyph index is looked up once, as the next glyph of the
+            // previous iteration, and carried forward for kerning
+            u32 index = fonts[i].size ?
+                tt_glyph_index(font_files[i], &font_infos[i], fonts[i].str[0]) : 0;
+
             for (u32 j = 0; j < fonts[i].size; j++) {
                 push_glyph(
-                    font_files[i], &font_infos[i], fonts[i].str[j],
-                    (v2_f32){ 75 * (f32)j, font_offset },
+                    font_files[i], &font_infos[i], index,
+                    (v2_f32){ pen_x, font_offset },
                     (v2_f32){ 100, -100 }
                 );
+
+                u32 next_index = j + 1 < fonts[i].size ?
+                    tt_glyph_index(font_files[i], &font_infos[i], fonts[i].str[j + 1]) : 0;
+
+                tt_hmetrics metrics = tt_glyph_hmetrics(font_files[i], &font_infos[i], index);
+                i32 advance = metrics.advance + tt_kern(&font_infos[i], index, next_index);
+
+                pen_x += (f32)advance * 100.0f / units_per_em;
+                index = next_index;
             }
 
             for (u32 y = 0; y < rows; y++) {
@@ -232,17 +306,31 @@ int main(int argc, char** argv) {
                     };
 
                     push_glyph(
-                        font_files[i], &font_infos[i], codepoint,
+                        font_files[i], &font_infos[i],
+                        tt_glyph_index(font_files[i], &font_infos[i], codepoint),
                         pos, (v2_f32){ 100, -100 }
                     );
                 }
             }
         }
 
+        PROF_END();
+
         glBindVertexArray(vert_array);
 
+        PROF_BEGIN("upload_buffers");
+
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, glyph_ssbo);
-        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, glyph_data_size, glyph_data);
+        if (pool_dirty_start < pool_dirty_end) {
+            glBufferSubData(
+                GL_SHADER_STORAGE_BUFFER, (GLintptr)pool_dirty_start,
+                (GLsizeiptr)(pool_dirty_end - pool_dirty_start),
+                glyph_cache->pool + pool_dirty_start
+            );
+
+            pool_dirty_start = ~(u64)0;
+            pool_dirty_end = 0;
+        }
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, glyph_ssbo);
 
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, instance_ssbo);
@@ -252,6 +340,8 @@ int main(int argc, char** argv) {
         glBindBuffer(GL_ARRAY_BUFFER, vert_buffer);
         glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(v2_f32) * 6 * num_glyphs, vertex_data);
 
+        PROF_END();
+
         glUseProgram(shader_prog);
         glUniformMatrix3fv(view_mat_loc, 1, GL_TRUE, view_mat.m);
 
@@ -411,6 +501,8 @@ int main(int argc, char** argv) {
 
         arena_clear(frame_arena);
 
+        PROF_END();
+
         {
             mem_arena_temp scratch = arena_scratch_get(NULL, 0);
 
@@ -426,10 +518,27 @@ int main(int argc, char** argv) {
         }
     }
 
+    // Open with chrome://tracing or https://ui.perfetto.dev
+    if (trace_path.size) {
+        string8_list trace = prof_trace_json(perm_arena);
+
+        if (!plat_file_write(trace_path, &trace, false)) {
+            error_emitf("Failed to write %.*s", STR8_FMT(trace_path));
+        }
+    }
+
+#ifdef ARENA_TELEMETRY
+    arena_telemetry_report(stdout, 32);
+#endif
+
     debug_draw_destroy();
 
     win_destroy(win);
 
+    for (u32 i = 0; i < NUM_FONTS; i++) {
+        plat_file_unmap(font_files[i]);
+    }
+
     arena_destroy(perm_arena);
 
     return 0;
@@ -470,8 +579,7 @@ void test_draw_glyph(
 ) {
     if (info == NULL || !info->initialized) { return; }
 
-    f32 units_per_em = (f32)_TT_READ_BE16(file.str + info->head.offset + 18);
-    scale = v2_f32_scale(scale, 1.0f / units_per_em);
+    scale = v2_f32_scale(scale, 1.0f / (f32)info->units_per_em);
 
     mem_arena_temp scratch = arena_scratch_get(NULL, 0);
 
@@ -534,17 +642,32 @@ void test_draw_glyph(
 
 void push_glyph(
     string8 file, tt_font_info* info,
-    u32 codepoint, v2_f32 translate, v2_f32 scale
+    u32 glyph_index, v2_f32 translate, v2_f32 scale
 ) {
     if (info == NULL || !info->initialized) { return; }
 
-    f32 units_per_em = (f32)_TT_READ_BE16(file.str + info->head.offset + 18);
-    scale = v2_f32_scale(scale, 1.0f / units_per_em);
+    scale = v2_f32_scale(scale, 1.0f / (f32)info->units_per_em);
 
-    mem_arena_temp scratch = arena_scratch_get(NULL, 0);
+    u64 misses = glyph_cache->misses;
 
-    tt_glyph_data glyph = tt_glyph_data_from_codepoint(scratch.arena, file, info, codepoint);
-    tt_glyph_color_edges(&glyph);
+    tt_glyph_cache_entry* entry = tt_glyph_cache_get_entry(glyph_cache, file, info, glyph_index);
+    if (entry == NULL) { return; }
+
+    tt_glyph_data glyph = entry->glyph;
+
+    // Glyphs too large for the pool are not in `glyph_ssbo`
+    if (entry->segments != NULL && entry->block_class > glyph_cache->root_class) { return; }
+
+    u64 pool_offset = entry->segments == NULL ? 0 :
+        (u64)((u8*)entry->segments - glyph_cache->pool);
+
+    // Newly cached segments are uploaded before drawing
+    // A miss can reuse the block of a glyph pushed earlier this frame,
+    // but only once the frame's glyphs do not all fit in the cache
+    if (glyph_cache->misses != misses && entry->segments != NULL) {
+        pool_dirty_start = MIN(pool_dirty_start, pool_offset);
+        pool_dirty_end = MAX(pool_dirty_end, pool_offset + glyph.num_segments * sizeof(tt_segment));
+    }
 
     u32 vi = num_glyphs * 6;
     vertex_data[vi+0] = (v2_f32){ glyph.x_min - 100, glyph.y_min - 100 };
@@ -558,26 +681,13 @@ void push_glyph(
         vertex_data[vi + i] = v2_f32_add(v2_f32_comp_mul(vertex_data[vi+i], scale), translate);
     }
 
-    u32 data_offset = glyph_data_size;
-
     instance_data[num_glyphs++] = (instance){
         .translate = translate,
         .scale = scale,
-        .data_offset = data_offset,
+        .data_offset = (u32)(pool_offset / sizeof(f32)),
         .num_segments = glyph.num_segments,
         .num_points = glyph.num_points,
     };
-
-    memcpy(glyph_data + data_offset, glyph.flags, glyph.num_points);
-    memcpy(
-        glyph_data + data_offset + ALIGN_UP_POW2(glyph.num_points, 4),
-        glyph.points,
-        glyph.num_points * sizeof(v2_i16)
-    );
-
-    glyph_data_size += ALIGN_UP_POW2(glyph.num_points, 4) + glyph.num_points * sizeof(v2_i16);
-    
-    arena_scratch_release(scratch);
 }
 
 string8 test_vert_source = GLSL_SOURCE(
@@ -588,13 +698,13 @@ string8 test_vert_source = GLSL_SOURCE(
     uniform mat3 u_view_mat;
 
     flat out int glyph_id;
-    out vec2 pos;
+    out vec2 world_pos;
 
     void main() {
         glyph_id = gl_VertexID / 6;
-        pos = a_pos;
+        world_pos = a_pos;
 
-        vec2 screen_pos = (u_view_mat * vec3(pos, 1.0)).xy;
+        vec2 screen_pos = (u_view_mat * vec3(world_pos, 1.0)).xy;
         gl_Position = vec4(screen_pos, 0.0, 1.0);
     }
 );
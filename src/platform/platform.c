@@ -1,7 +1,42 @@
 
 #if defined(PLATFORM_WIN32)
 #include "platform_win32.c"
-#elif define(PLATFORM_LINUX)
+#elif defined(PLATFORM_LINUX)
 #include "platform_linux.c"
 #endif
 
+void plat_semaphore_init(plat_semaphore* sem, u32 count) {
+    sem->count = count;
+    sem->num_waiters = 0;
+}
+
+void plat_semaphore_wait(plat_semaphore* sem) {
+    while (true) {
+        u32 count = ATOMIC_LOAD_U32(&sem->count);
+
+        if (count > 0) {
+            if (ATOMIC_CAS_U32(&sem->count, count, count - 1)) { return; }
+
+            continue;
+        }
+
+        // The futex only sleeps if the count is still zero, so a post
+        // between the load and the wait is not missed
+        ATOMIC_ADD_U32(&sem->num_waiters, 1);
+        _plat_futex_wait(&sem->count, 0);
+        ATOMIC_SUB_U32(&sem->num_waiters, 1);
+    }
+}
+
+void plat_semaphore_post(plat_semaphore* sem, u32 count) {
+    if (count == 0) { return; }
+
+    ATOMIC_ADD_U32(&sem->count, count);
+
+    if (ATOMIC_LOAD_U32(&sem->num_waiters) > 0) {
+        _plat_futex_wake(&sem->count, count);
+    }
+}
+
+#include "platform_jobs.c"
+
@@ -9,11 +9,16 @@
 
 #elif defined(PLATFORM_LINUX)
 
+#include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 #endif
 
@@ -25,6 +30,8 @@ string8 plat_get_name(void);
 void plat_fatal_error(const char* msg, i32 code);
 
 u64 plat_time_usec(void);
+// Monotonic, for timing short intervals
+u64 plat_time_nsec(void);
 void plat_sleep_ms(u32 ms);
 
 u64 plat_file_size(string8 file_name);
@@ -32,6 +39,12 @@ string8 plat_file_read(mem_arena* arena, string8 file_name);
 b32 plat_file_write(string8 file_name, const string8_list* list, b32 append);
 b32 plat_file_delete(string8 file_name);
 
+// Maps the file read-only without copying it into memory
+// Pages are only loaded as they are read
+// Returns an empty string on failure
+string8 plat_file_map(string8 file_name);
+void plat_file_unmap(string8 file);
+
 void plat_get_entropy(void* data, u64 size);
 
 // returns NULL on failure
@@ -40,5 +53,52 @@ b32 plat_mem_commit(void* mem, u64 size);
 b32 plat_mem_decommit(void* mem, u64 size);
 b32 plat_mem_release(void* mem, u64 size);
 
+// Huge pages on x64 and on arm64 with 4 KiB pages
+#define PLAT_HUGE_PAGE_SIZE MiB(2)
+
+// Like `plat_mem_reserve`, but aligned to `PLAT_HUGE_PAGE_SIZE` and
+// backed by huge pages where the OS can (transparent huge pages on Linux)
+// `size` must be a multiple of `PLAT_HUGE_PAGE_SIZE`, and commits should be
+// too, since a huge page is only used for a fully committed aligned range
+// Falls back to normal pages elsewhere
+void* plat_mem_reserve_huge(u64 size);
+// Faults in committed memory ahead of its first use
+void plat_mem_prefault(void* mem, u64 size);
+
 u32 plat_page_size(void);
 
+// Number of logical processors available to the process
+u32 plat_num_cpus(void);
+
+typedef void (plat_thread_func)(void* arg);
+
+typedef struct plat_thread plat_thread;
+
+// The thread starts running immediately
+// Its scratch arenas are destroyed when `func` returns
+// `arena` has to outlive the thread
+// Returns NULL on failure
+plat_thread* plat_thread_create(mem_arena* arena, plat_thread_func* func, void* arg);
+
+// Waits for the thread to finish and releases its handle
+void plat_thread_join(plat_thread* thread);
+
+// Lets another thread run on the calling thread's cpu
+void plat_thread_yield(void);
+
+// Counting semaphore on top of futexes (`WaitOnAddress` on win32),
+// which only makes system calls when a thread has to sleep or be woken
+// Must not be moved or copied while in use
+typedef struct {
+    u32 count;
+    u32 num_waiters;
+} plat_semaphore;
+
+void plat_semaphore_init(plat_semaphore* sem, u32 count);
+// Sleeps until the count is above zero, then decrements it
+void plat_semaphore_wait(plat_semaphore* sem);
+// Increments the count by `count`, waking up to `count` waiting threads
+void plat_semaphore_post(plat_semaphore* sem, u32 count);
+
+#include "platform_jobs.h"
+
@@ -0,0 +1,372 @@
+
+#define _PLAT_JOBS_DEQUE_MASK (PLAT_JOBS_DEQUE_SIZE - 1)
+// Keeps values written by different threads on different cache lines
+#define _PLAT_JOBS_CACHE_LINE 64
+// Yields in `plat_jobs_wait` with nothing to run, before it sleeps
+#define _PLAT_JOBS_WAIT_SPINS 64
+
+STATIC_ASSERT((PLAT_JOBS_DEQUE_SIZE & _PLAT_JOBS_DEQUE_MASK) == 0, plat_jobs_deque_size);
+
+typedef struct {
+    plat_job_func* func;
+    void* arg;
+    plat_job_counter* counter;
+} _plat_job;
+
+// Chase-Lev deque, with a fixed size buffer
+// `top` and `bottom` only grow (apart from `bottom` going back down by
+// one in `_plat_jobs_pop`), and are wrapped with the mask when indexing
+typedef struct {
+    // Changed by thieves, and by the owner when taking the last job
+    u64 top;
+    u8 _top_pad[_PLAT_JOBS_CACHE_LINE - sizeof(u64)];
+
+    // Only changed by the owner
+    u64 bottom;
+    u8 _bottom_pad[_PLAT_JOBS_CACHE_LINE - sizeof(u64)];
+
+    _plat_job* jobs;
+} _plat_job_deque;
+
+typedef struct {
+    plat_job_system* system;
+    u32 index;
+} _plat_job_worker;
+
+struct plat_job_system {
+    u32 num_threads;
+    // One per thread, with the creating thread at index 0
+    _plat_job_deque* deques;
+
+    _plat_job_worker* workers;
+    plat_thread** threads;
+
+    u32 shutdown;
+
+    // Workers that are sleeping, or about to, on `wake`
+    // Submitting a job claims one of them and posts to the semaphore
+    u32 num_sleeping;
+    plat_semaphore wake;
+
+    // Threads sleeping in `plat_jobs_wait` wait for `wait_epoch` to change
+    // It is bumped when a counter reaches zero, or when a job is submitted
+    // and no worker was sleeping, so waiters can help with it
+    // Counters are often on the waiter's stack, and may be gone as soon
+    // as they reach zero, which is why the futex is not on the counter
+    u32 num_waiting;
+    u32 wait_epoch;
+};
+
+// Set on the creating thread and on every worker
+static THREAD_LOCAL plat_job_system* _plat_jobs_system = NULL;
+static THREAD_LOCAL u32 _plat_jobs_index = 0;
+// Used to pick which deque to steal from first
+static THREAD_LOCAL prng _plat_jobs_rng = { 0 };
+
+b32 _plat_jobs_push(_plat_job_deque* deque, _plat_job job) {
+    u64 bottom = ATOMIC_LOAD_U64(&deque->bottom);
+    u64 top = ATOMIC_LOAD_U64(&deque->top);
+
+    if (bottom - top >= PLAT_JOBS_DEQUE_SIZE) {
+        return false;
+    }
+
+    deque->jobs[bottom & _PLAT_JOBS_DEQUE_MASK] = job;
+    ATOMIC_STORE_U64(&deque->bottom, bottom + 1);
+
+    return true;
+}
+
+// Only called by the owner of the deque
+b32 _plat_jobs_pop(_plat_job_deque* deque, _plat_job* out) {
+    u64 bottom = ATOMIC_LOAD_U64(&deque->bottom) - 1;
+    ATOMIC_STORE_U64(&deque->bottom, bottom);
+
+    u64 top = ATOMIC_LOAD_U64(&deque->top);
+
+    if ((i64)(bottom - top) < 0) {
+        ATOMIC_STORE_U64(&deque->bottom, bottom + 1);
+        return false;
+    }
+
+    *out = deque->jobs[bottom & _PLAT_JOBS_DEQUE_MASK];
+
+    if (bottom != top) {
+        return true;
+    }
+
+    // Last job, which thieves might be trying to take as well
+    b32 taken = ATOMIC_CAS_U64(&deque->top, top, top + 1);
+    ATOMIC_STORE_U64(&deque->bottom, bottom + 1);
+
+    return taken;
+}
+
+b32 _plat_jobs_steal(_plat_job_deque* deque, _plat_job* out) {
+    u64 top = ATOMIC_LOAD_U64(&deque->top);
+    u64 bottom = ATOMIC_LOAD_U64(&deque->bottom);
+
+    if ((i64)(bottom - top) <= 0) {
+        return false;
+    }
+
+    // The slot can only be overwritten once `top` has moved past it,
+    // in which case the exchange fails and the copy is thrown away
+    _plat_job job = deque->jobs[top & _PLAT_JOBS_DEQUE_MASK];
+
+    if (!ATOMIC_CAS_U64(&deque->top, top, top + 1)) {
+        return false;
+    }
+
+    *out = job;
+
+    return true;
+}
+
+b32 _plat_jobs_find(plat_job_system* jobs, u32 index, _plat_job* out) {
+    if (_plat_jobs_pop(&jobs->deques[index], out)) {
+        return true;
+    }
+
+    u32 num_threads = jobs->num_threads;
+    if (num_threads == 1) { return false; }
+
+    // Starting at a random deque keeps thieves from all going for the same one
+    u32 start = prng_rand_r(&_plat_jobs_rng) % num_threads;
+
+    for (u32 i = 0; i < num_threads; i++) {
+        u32 victim = (start + i) % num_threads;
+        if (victim == index) { continue; }
+
+        if (_plat_jobs_steal(&jobs->deques[victim], out)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+b32 _plat_jobs_any_queued(plat_job_system* jobs) {
+    for (u32 i = 0; i < jobs->num_threads; i++) {
+        _plat_job_deque* deque = &jobs->deques[i];
+
+        u64 top = ATOMIC_LOAD_U64(&deque->top);
+        u64 bottom = ATOMIC_LOAD_U64(&deque->bottom);
+
+        if ((i64)(bottom - top) > 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void _plat_jobs_wake_waiting(plat_job_system* jobs) {
+    if (ATOMIC_LOAD_U32(&jobs->num_waiting) > 0) {
+        ATOMIC_ADD_U32(&jobs->wait_epoch, 1);
+        _plat_futex_wake(&jobs->wait_epoch, ~(u32)0);
+    }
+}
+
+void _plat_jobs_run(_plat_job job) {
+    mem_scratch_mark mark = arena_scratch_mark();
+
+    job.func(job.arg);
+
+    arena_scratch_restore(mark);
+
+    if (job.counter == NULL) { return; }
+
+    // The counter must not be touched once it reaches zero
+    plat_job_system* jobs = _plat_jobs_system;
+    if (ATOMIC_SUB_U32(&job.counter->pending, 1) == 0 && jobs != NULL) {
+        _plat_jobs_wake_waiting(jobs);
+    }
+}
+
+// Returns false if no worker was sleeping
+b32 _plat_jobs_wake_one(plat_job_system* jobs) {
+    u32 num_sleeping = ATOMIC_LOAD_U32(&jobs->num_sleeping);
+
+    while (num_sleeping > 0) {
+        if (ATOMIC_CAS_U32(&jobs->num_sleeping, num_sleeping, num_sleeping - 1)) {
+            plat_semaphore_post(&jobs->wake, 1);
+            return true;
+        }
+
+        num_sleeping = ATOMIC_LOAD_U32(&jobs->num_sleeping);
+    }
+
+    return false;
+}
+
+void _plat_jobs_sleep(plat_job_system* jobs) {
+    ATOMIC_ADD_U32(&jobs->num_sleeping, 1);
+
+    // A job submitted before the worker was counted would not wake it,
+    // so the deques are checked again once it has been
+    if (_plat_jobs_any_queued(jobs) || ATOMIC_LOAD_U32(&jobs->shutdown)) {
+        u32 num_sleeping = ATOMIC_LOAD_U32(&jobs->num_sleeping);
+
+        while (num_sleeping > 0) {
+            if (ATOMIC_CAS_U32(&jobs->num_sleeping, num_sleeping, num_sleeping - 1)) {
+                return;
+            }
+
+            num_sleeping = ATOMIC_LOAD_U32(&jobs->num_sleeping);
+        }
+
+        // Every sleeping worker has been claimed, and so has been
+        // posted for (or is about to be), so the post is taken below
+    }
+
+    plat_semaphore_wait(&jobs->wake);
+}
+
+void _plat_jobs_worker_entry(void* arg) {
+    _plat_job_worker* worker = (_plat_job_worker*)arg;
+    plat_job_system* jobs = worker->system;
+
+    _plat_jobs_system = jobs;
+    _plat_jobs_index = worker->index;
+    prng_seed_r(&_plat_jobs_rng, (u64)worker->index, (u64)(uintptr_t)worker);
+
+    while (true) {
+        _plat_job job = { 0 };
+
+        if (_plat_jobs_find(jobs, worker->index, &job)) {
+            _plat_jobs_run(job);
+            continue;
+        }
+
+        // Workers only stop once there is nothing left to steal
+        if (ATOMIC_LOAD_U32(&jobs->shutdown)) {
+            break;
+        }
+
+        _plat_jobs_sleep(jobs);
+    }
+
+    _plat_jobs_system = NULL;
+}
+
+plat_job_system* plat_jobs_create(mem_arena* arena, u32 num_threads) {
+    if (num_threads == 0) {
+        num_threads = plat_num_cpus();
+    }
+
+    plat_job_system* jobs = PUSH_STRUCT(arena, plat_job_system);
+    jobs->num_threads = num_threads;
+    jobs->deques = PUSH_ARRAY(arena, _plat_job_deque, num_threads);
+    jobs->workers = PUSH_ARRAY(arena, _plat_job_worker, num_threads);
+    jobs->threads = PUSH_ARRAY(arena, plat_thread*, num_threads);
+
+    plat_semaphore_init(&jobs->wake, 0);
+
+    for (u32 i = 0; i < num_threads; i++) {
+        jobs->deques[i].jobs = PUSH_ARRAY_NZ(arena, _plat_job, PLAT_JOBS_DEQUE_SIZE);
+        jobs->workers[i] = (_plat_job_worker){ jobs, i };
+    }
+
+    _plat_jobs_system = jobs;
+    _plat_jobs_index = 0;
+    prng_seed_r(&_plat_jobs_rng, 0, (u64)(uintptr_t)jobs);
+
+    for (u32 i = 1; i < num_threads; i++) {
+        jobs->threads[i] = plat_thread_create(arena, _plat_jobs_worker_entry, &jobs->workers[i]);
+
+        // The deque is still emptied by the other threads
+        if (jobs->threads[i] == NULL) {
+            error_emitf("Failed to start job worker %u", i);
+        }
+    }
+
+    return jobs;
+}
+
+void plat_jobs_destroy(plat_job_system* jobs) {
+    if (jobs == NULL) { return; }
+
+    _plat_job job = { 0 };
+    while (_plat_jobs_find(jobs, 0, &job)) {
+        _plat_jobs_run(job);
+    }
+
+    ATOMIC_STORE_U32(&jobs->shutdown, 1);
+    while (_plat_jobs_wake_one(jobs));
+
+    for (u32 i = 1; i < jobs->num_threads; i++) {
+        plat_thread_join(jobs->threads[i]);
+    }
+
+    if (_plat_jobs_system == jobs) {
+        _plat_jobs_system = NULL;
+    }
+}
+
+u32 plat_jobs_num_threads(const plat_job_system* jobs) {
+    return jobs->num_threads;
+}
+
+void plat_jobs_submit(
+    plat_job_system* jobs, plat_job_func* func,
+    void* arg, plat_job_counter* counter
+) {
+    _plat_job job = { func, arg, counter };
+
+    if (counter != NULL) {
+        ATOMIC_ADD_U32(&counter->pending, 1);
+    }
+
+    if (jobs == NULL || _plat_jobs_system != jobs) {
+        _plat_jobs_run(job);
+        return;
+    }
+
+    if (!_plat_jobs_push(&jobs->deques[_plat_jobs_index], job)) {
+        _plat_jobs_run(job);
+        return;
+    }
+
+    if (!_plat_jobs_wake_one(jobs)) {
+        _plat_jobs_wake_waiting(jobs);
+    }
+}
+
+void plat_jobs_wait(plat_job_system* jobs, plat_job_counter* counter) {
+    b32 in_system = jobs != NULL && _plat_jobs_system == jobs;
+
+    u32 num_spins = 0;
+
+    while (ATOMIC_LOAD_U32(&counter->pending) > 0) {
+        _plat_job job = { 0 };
+
+        if (in_system && _plat_jobs_find(jobs, _plat_jobs_index, &job)) {
+            _plat_jobs_run(job);
+            num_spins = 0;
+            continue;
+        }
+
+        // The remaining jobs are running on other threads, which
+        // usually finish soon when the jobs are small
+        if (jobs == NULL || num_spins < _PLAT_JOBS_WAIT_SPINS) {
+            plat_thread_yield();
+            num_spins++;
+            continue;
+        }
+
+        // The epoch is read before the counter, so a change of the
+        // counter after it was read makes the futex return right away
+        ATOMIC_ADD_U32(&jobs->num_waiting, 1);
+
+        u32 epoch = ATOMIC_LOAD_U32(&jobs->wait_epoch);
+        if (ATOMIC_LOAD_U32(&counter->pending) > 0) {
+            _plat_futex_wait(&jobs->wait_epoch, epoch);
+        }
+
+        ATOMIC_SUB_U32(&jobs->num_waiting, 1);
+
+        num_spins = 0;
+    }
+}
+
@@ -0,0 +1,48 @@
+
+// Work-stealing job system
+// Every thread of a system (the one that created it and its workers)
+// has its own deque of jobs. Threads push and pop jobs at the bottom of
+// their deque, and steal from the top of other deques when theirs is empty
+
+// Max number of queued jobs per thread, must be a power of two
+// Jobs submitted to a full deque are run right away
+#define PLAT_JOBS_DEQUE_SIZE 4096
+
+typedef void (plat_job_func)(void* arg);
+
+// Number of jobs submitted with the counter that have not finished yet
+// Must be zero initialized, and must outlive its jobs
+typedef struct {
+    u32 pending;
+} plat_job_counter;
+
+typedef struct plat_job_system plat_job_system;
+
+// Starts `num_threads - 1` workers, with the calling thread as the
+// remaining thread of the system (one thread per cpu if `num_threads` is 0)
+// `arena` has to outlive the system
+plat_job_system* plat_jobs_create(mem_arena* arena, u32 num_threads);
+
+// Runs the remaining jobs, then stops the workers
+// Must be called from the thread that created the system
+void plat_jobs_destroy(plat_job_system* jobs);
+
+// Including the thread that created the system
+u32 plat_jobs_num_threads(const plat_job_system* jobs);
+
+// Queues `func(arg)` on the calling thread's deque, and increments
+// `counter` (which can be NULL) until the job has finished
+// Jobs can submit other jobs. Jobs submitted from a thread that is
+// not part of the system are run right away
+// Each job runs with the scratch arenas of the thread that runs it,
+// and whatever it leaves on them is popped once it returns
+void plat_jobs_submit(
+    plat_job_system* jobs, plat_job_func* func,
+    void* arg, plat_job_counter* counter
+);
+
+// Runs queued jobs until every job of `counter` has finished, and sleeps
+// once there are none left to run while the others finish on other threads
+// Can be called from inside a job, to wait for the jobs it submitted
+void plat_jobs_wait(plat_job_system* jobs, plat_job_counter* counter);
+
@@ -1,5 +1,7 @@
 
-void plat_init(void) { }
+void plat_init(void) {
+    simd_init();
+}
 
 string8 plat_get_name(void) {
     return STR8_LIT("linux");
@@ -20,6 +22,16 @@ u64 plat_time_usec(void) {
     return (u64)ts.tv_sec * 1000000 + (u64)ts.tv_nsec / 1000;
 }
 
+u64 plat_time_nsec(void) {
+    struct timespec ts = { 0 };
+    if (-1 == clock_gettime(CLOCK_MONOTONIC, &ts)) {
+        error_emit("Failed to get time");
+        return 0;
+    }
+
+    return (u64)ts.tv_sec * 1000000000 + (u64)ts.tv_nsec;
+}
+
 void plat_sleep_ms(u32 ms) {
     usleep(ms * 1000);
 }
@@ -119,7 +131,7 @@ b32 plat_file_write(string8 file_name, const string8_list* list, b32 append) {
     {
         mem_arena_temp scratch = arena_scratch_get(NULL, 0);
 
-        string8 full_file = str8_concat(scratch.arena, list);
+        string8 full_file = str8_concat_simple(scratch.arena, list);
 
         u64 total_written = 0;
         while (total_written < full_file.size) {
@@ -157,6 +169,63 @@ b32 plat_file_delete(string8 file_name) {
     return ret == 0;
 }
 
+string8 plat_file_map(string8 file_name) {
+    i32 fd = -1;
+
+    mem_arena_temp scratch = arena_scratch_get(NULL, 0);
+
+    u8* name_cstr = str8_to_cstr(scratch.arena, file_name);
+    fd = open((char*)name_cstr, O_RDONLY);
+
+    arena_scratch_release(scratch);
+
+    if (fd == -1) {
+        error_emitf("Failed to open file \"%.*s\"", (int)file_name.size, (char*)file_name.str);
+        return (string8){ 0 };
+    }
+
+    string8 out = { 0 };
+
+    struct stat file_stats = { 0 };
+    if (fstat(fd, &file_stats) == -1) {
+        error_emitf("Failed to open file \"%.*s\"", (int)file_name.size, (char*)file_name.str);
+        goto end;
+    }
+
+    if (!S_ISREG(file_stats.st_mode) || file_stats.st_size == 0) {
+        error_emitf("Incorrect mode for mapping of file \"%.*s\"", (int)file_name.size, (char*)file_name.str);
+        goto end;
+    }
+
+    u64 size = (u64)file_stats.st_size;
+    void* mem = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (mem == MAP_FAILED) {
+        error_emitf("Failed to map file \"%.*s\"", (int)file_name.size, (char*)file_name.str);
+        goto end;
+    }
+
+    // Files are usually accessed through offset tables,
+    // so readahead would mostly fault in pages that are never used.
+    // The first page generally holds the table directory
+    madvise(mem, size, MADV_RANDOM);
+    madvise(mem, MIN(size, plat_page_size()), MADV_WILLNEED);
+
+    out.str = mem;
+    out.size = size;
+
+end:
+    // The mapping stays valid after the file is closed
+    close(fd);
+    return out;
+}
+
+void plat_file_unmap(string8 file) {
+    if (file.str == NULL) { return; }
+
+    munmap(file.str, file.size);
+}
+
 void plat_get_entropy(void* data, u64 size) {
     getentropy(data, size);
 }
@@ -169,21 +238,121 @@ void* plat_mem_reserve(u64 size) {
     return out;
 }
 
+void* plat_mem_reserve_huge(u64 size) {
+    // Reserved with room to spare, then trimmed to an aligned range
+    u64 padded_size = size + PLAT_HUGE_PAGE_SIZE;
+
+    u8* mem = mmap(NULL, padded_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        return NULL;
+    }
+
+    u8* aligned = (u8*)ALIGN_UP_POW2((u64)(uintptr_t)mem, PLAT_HUGE_PAGE_SIZE);
+    u64 head_size = (u64)(aligned - mem);
+    u64 tail_size = padded_size - head_size - size;
+
+    if (head_size) { munmap(mem, head_size); }
+    if (tail_size) { munmap(aligned + size, tail_size); }
+
+    // Carried over to the pages once they are committed
+    madvise(aligned, size, MADV_HUGEPAGE);
+
+    return aligned;
+}
+
+void plat_mem_prefault(void* mem, u64 size) {
+#ifdef MADV_POPULATE_WRITE
+    // Linux 5.14+, faults in every page with a single call
+    // Older kernels fail with EINVAL and fall through to touching each page
+    if (madvise(mem, size, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+#endif
+
+    u32 page_size = plat_page_size();
+
+    for (u64 i = 0; i < size; i += page_size) {
+        volatile u8* page = (u8*)mem + i;
+        *page = *page;
+    }
+}
+
 b32 plat_mem_commit(void* mem, u64 size) {
     i32 ret = mprotect(mem, size, PROT_READ | PROT_WRITE);
     return ret == 0;
 }
 
-void plat_mem_decommit(void* mem, u64 size) {
-    mprotect(mem, size, PROT_NONE);
+b32 plat_mem_decommit(void* mem, u64 size) {
+    i32 ret = mprotect(mem, size, PROT_NONE);
     madvise(mem, size, MADV_DONTNEED);
+    return ret == 0;
 }
 
-void plat_mem_release(void* mem, u64 size) {
-    munmap(mem, size);
+b32 plat_mem_release(void* mem, u64 size) {
+    i32 ret = munmap(mem, size);
+    return ret == 0;
 }
 
 u32 plat_page_size(void) {
     return (u32)sysconf(_SC_PAGESIZE);
 }
 
+u32 plat_num_cpus(void) {
+    i64 num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return num_cpus > 0 ? (u32)num_cpus : 1;
+}
+
+struct plat_thread {
+    pthread_t handle;
+
+    plat_thread_func* func;
+    void* arg;
+};
+
+void* _plat_thread_entry(void* arg) {
+    plat_thread* thread = (plat_thread*)arg;
+
+    thread->func(thread->arg);
+
+    arena_scratch_free();
+    prof_thread_release();
+
+    return NULL;
+}
+
+plat_thread* plat_thread_create(mem_arena* arena, plat_thread_func* func, void* arg) {
+    mem_arena_temp maybe_temp = arena_temp_begin(arena);
+
+    plat_thread* thread = PUSH_STRUCT(arena, plat_thread);
+    thread->func = func;
+    thread->arg = arg;
+
+    if (pthread_create(&thread->handle, NULL, _plat_thread_entry, thread) != 0) {
+        error_emit("Failed to create thread");
+
+        arena_temp_end(maybe_temp);
+        return NULL;
+    }
+
+    return thread;
+}
+
+void plat_thread_join(plat_thread* thread) {
+    if (thread == NULL) { return; }
+
+    pthread_join(thread->handle, NULL);
+}
+
+void plat_thread_yield(void) {
+    sched_yield();
+}
+
+// Sleeps while `*addr == expected`, or until woken
+void _plat_futex_wait(u32* addr, u32 expected) {
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+void _plat_futex_wake(u32* addr, u32 count) {
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, (i32)MIN(count, (u32)INT32_MAX), NULL, NULL, 0);
+}
+
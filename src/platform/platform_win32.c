@@ -2,6 +2,8 @@
 #define _DWORD_MAX (~(DWORD)0)
 
 void plat_init(void) {
+    simd_init();
+
     LARGE_INTEGER perf_freq = { 0 };
 
     if (QueryPerformanceFrequency(&perf_freq)) {
@@ -31,6 +33,21 @@ u64 plat_time_usec(void) {
     return (u64)ticks.QuadPart * 1000000 / w32_perf_freq;
 }
 
+u64 plat_time_nsec(void) {
+    LARGE_INTEGER ticks = { 0 };
+
+    if (!QueryPerformanceCounter(&ticks)) {
+        error_emit("Failed to query performance counter");
+        return 0;
+    }
+
+    // Split to keep the multiplication from overflowing
+    u64 secs = (u64)ticks.QuadPart / w32_perf_freq;
+    u64 rem = (u64)ticks.QuadPart % w32_perf_freq;
+
+    return secs * 1000000000 + rem * 1000000000 / w32_perf_freq;
+}
+
 void plat_sleep_ms(u32 ms) {
     Sleep(ms);
 }
@@ -171,6 +188,62 @@ b32 plat_file_delete(string8 file_name) {
     return ret;
 }
 
+string8 plat_file_map(string8 file_name) {
+    mem_arena_temp scratch = arena_scratch_get(NULL, 0);
+
+    string16 file_name16 = str16_from_str8(scratch.arena, file_name, true);
+
+    // Random access hint, since files are usually accessed through offset tables
+    HANDLE file_handle = CreateFileW(
+        (LPCWSTR)file_name16.str, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL
+    );
+
+    arena_scratch_release(scratch);
+
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        error_emitf("Failed to open file \"%.*s\"", (int)file_name.size, (char*)file_name.str);
+        return (string8){ 0 };
+    }
+
+    string8 out = { 0 };
+
+    LARGE_INTEGER file_size = { 0 };
+    if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0) {
+        error_emitf("Failed to get size of file \"%.*s\"", (int)file_name.size, (char*)file_name.str);
+        CloseHandle(file_handle);
+        return out;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (mapping != NULL) {
+        void* mem = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+        if (mem != NULL) {
+            out.str = mem;
+            out.size = (u64)file_size.QuadPart;
+        }
+
+        // The view keeps the mapping alive
+        CloseHandle(mapping);
+    }
+
+    if (out.str == NULL) {
+        error_emitf("Failed to map file \"%.*s\"", (int)file_name.size, (char*)file_name.str);
+    }
+
+    CloseHandle(file_handle);
+
+    return out;
+}
+
+void plat_file_unmap(string8 file) {
+    if (file.str == NULL) { return; }
+
+    UnmapViewOfFile(file.str);
+}
+
 void plat_get_entropy(void* data, u64 size) {
     BCryptGenRandom(NULL, data, (u32)(size & (~(u32)0)), BCRYPT_USE_SYSTEM_PREFERRED_RNG);
 }
@@ -180,6 +253,21 @@ void* plat_mem_reserve(u64 size) {
     return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_READWRITE);
 }
 
+void* plat_mem_reserve_huge(u64 size) {
+    // Large pages on Windows need the "Lock pages in memory" privilege,
+    // and have to be committed along with the reserve, so normal pages are used
+    return plat_mem_reserve(size);
+}
+
+void plat_mem_prefault(void* mem, u64 size) {
+    u32 page_size = plat_page_size();
+
+    for (u64 i = 0; i < size; i += page_size) {
+        volatile u8* page = (u8*)mem + i;
+        *page = *page;
+    }
+}
+
 b32 plat_mem_commit(void* mem, u64 size) {
     void* ret = VirtualAlloc(mem, size, MEM_COMMIT, PAGE_READWRITE);
     return ret != NULL;
@@ -199,3 +287,70 @@ u32 plat_page_size(void) {
     return si.dwPageSize;
 }
 
+u32 plat_num_cpus(void) {
+    SYSTEM_INFO si = { 0 };
+    GetSystemInfo(&si);
+    return MAX(1, si.dwNumberOfProcessors);
+}
+
+struct plat_thread {
+    HANDLE handle;
+
+    plat_thread_func* func;
+    void* arg;
+};
+
+DWORD WINAPI _plat_thread_entry(LPVOID arg) {
+    plat_thread* thread = (plat_thread*)arg;
+
+    thread->func(thread->arg);
+
+    arena_scratch_free();
+    prof_thread_release();
+
+    return 0;
+}
+
+plat_thread* plat_thread_create(mem_arena* arena, plat_thread_func* func, void* arg) {
+    mem_arena_temp maybe_temp = arena_temp_begin(arena);
+
+    plat_thread* thread = PUSH_STRUCT(arena, plat_thread);
+    thread->func = func;
+    thread->arg = arg;
+
+    thread->handle = CreateThread(NULL, 0, _plat_thread_entry, thread, 0, NULL);
+
+    if (thread->handle == NULL) {
+        error_emit("Failed to create thread");
+
+        arena_temp_end(maybe_temp);
+        return NULL;
+    }
+
+    return thread;
+}
+
+void plat_thread_join(plat_thread* thread) {
+    if (thread == NULL) { return; }
+
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+void plat_thread_yield(void) {
+    SwitchToThread();
+}
+
+// Sleeps while `*addr == expected`, or until woken
+void _plat_futex_wait(u32* addr, u32 expected) {
+    WaitOnAddress(addr, &expected, sizeof(u32), INFINITE);
+}
+
+void _plat_futex_wake(u32* addr, u32 count) {
+    if (count == 1) {
+        WakeByAddressSingle(addr);
+    } else {
+        WakeByAddressAll(addr);
+    }
+}
+
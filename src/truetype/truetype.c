@@ -2,4 +2,8 @@
 #include "truetype_parse.c"
 #include "truetype_render_common.c"
 #include "truetype_render_cpu.c"
+#include "truetype_cache.c"
+#include "truetype_atlas.c"
+#include "truetype_extract.c"
+#include "truetype_kern.c"
 
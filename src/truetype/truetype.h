@@ -42,4 +42,8 @@ typedef struct {
 
 #include "truetype_parse.h"
 #include "truetype_render.h"
+#include "truetype_cache.h"
+#include "truetype_atlas.h"
+#include "truetype_extract.h"
+#include "truetype_kern.h"
 
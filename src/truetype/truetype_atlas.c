@@ -0,0 +1,460 @@
+
+tt_atlas* tt_atlas_create(
+    mem_arena* arena, tt_atlas_format format,
+    u32 page_width, u32 page_height, u32 max_pages,
+    u32 padding, u32 num_buckets
+) {
+    // Rounding up to a power of two so the hash can be masked
+    u32 buckets_pow2 = 1;
+    while (buckets_pow2 < num_buckets) {
+        buckets_pow2 <<= 1;
+    }
+
+    tt_atlas* atlas = PUSH_STRUCT(arena, tt_atlas);
+
+    atlas->arena = arena;
+    atlas->format = format;
+    atlas->bytes_per_pixel = format == TT_ATLAS_FORMAT_RGB8 ? 3 : 1;
+    atlas->page_width = page_width;
+    atlas->page_height = page_height;
+    atlas->padding = padding;
+    atlas->max_pages = MAX(1, max_pages);
+    atlas->pages = PUSH_ARRAY(arena, tt_atlas_page, atlas->max_pages);
+    atlas->num_buckets = buckets_pow2;
+    atlas->buckets = PUSH_ARRAY(arena, tt_atlas_entry*, buckets_pow2);
+
+    return atlas;
+}
+
+void tt_atlas_frame_begin(tt_atlas* atlas) {
+    atlas->frame++;
+
+    for (u32 i = 0; i < atlas->num_pages; i++) {
+        atlas->pages[i].num_dirty_rects = 0;
+    }
+}
+
+u32 _tt_atlas_hash(const tt_font_info* font, u32 glyph_index, u32 variant) {
+    u64 h = (u64)(uintptr_t)font;
+    h ^= (u64)glyph_index * 0x9E3779B97F4A7C15ULL;
+    h ^= (u64)variant * 0xC2B2AE3D27D4EB4FULL;
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ULL;
+    h ^= h >> 32;
+
+    return (u32)h;
+}
+
+tt_atlas_entry* tt_atlas_find(
+    tt_atlas* atlas, const tt_font_info* font,
+    u32 glyph_index, u32 variant
+) {
+    u32 bucket = _tt_atlas_hash(font, glyph_index, variant) & (atlas->num_buckets - 1);
+
+    for (
+        tt_atlas_entry* entry = atlas->buckets[bucket];
+        entry != NULL; entry = entry->hash_next
+    ) {
+        if (
+            entry->font == font && entry->glyph_index == glyph_index &&
+            entry->variant == variant
+        ) {
+            atlas->pages[entry->page].last_used_frame = atlas->frame;
+            atlas->hits++;
+
+            return entry;
+        }
+    }
+
+    atlas->misses++;
+
+    return NULL;
+}
+
+void _tt_atlas_page_reset(tt_atlas* atlas, tt_atlas_page* page) {
+    page->num_nodes = 1;
+    page->nodes[0] = (_tt_atlas_skyline_node){ 0, 0, atlas->page_width };
+
+    page->entries = NULL;
+    page->num_entries = 0;
+    page->used_pixels = 0;
+    page->num_dirty_rects = 0;
+}
+
+void _tt_atlas_page_evict(tt_atlas* atlas, tt_atlas_page* page) {
+    for (tt_atlas_entry* entry = page->entries; entry != NULL;) {
+        tt_atlas_entry* next = entry->next;
+
+        u32 bucket = _tt_atlas_hash(entry->font, entry->glyph_index, entry->variant) &
+            (atlas->num_buckets - 1);
+
+        tt_atlas_entry** link = &atlas->buckets[bucket];
+        while (*link != entry) {
+            link = &(*link)->hash_next;
+        }
+        *link = entry->hash_next;
+
+        SLL_STACK_PUSH(atlas->free_entries, entry);
+
+        atlas->evicted_glyphs++;
+        entry = next;
+    }
+
+    _tt_atlas_page_reset(atlas, page);
+
+    atlas->evicted_pages++;
+}
+
+// Bottom left skyline packing: the rect goes where its top is lowest,
+// which keeps the skyline flat
+// Returns false if the rect does not fit anywhere in the page
+b32 _tt_atlas_skyline_fit(
+    const tt_atlas* atlas, const tt_atlas_page* page,
+    u32 width, u32 height, u32* out_node, u32* out_y
+) {
+    u32 best_node = ~(u32)0;
+    u32 best_top = ~(u32)0;
+    u32 best_width = ~(u32)0;
+    u32 best_y = 0;
+
+    for (u32 i = 0; i < page->num_nodes; i++) {
+        u32 x = page->nodes[i].x;
+        if (x + width > atlas->page_width) { break; }
+
+        // The rect rests on the highest node it spans
+        u32 y = 0;
+        u32 remaining = width;
+        for (u32 j = i; remaining > 0; j++) {
+            y = MAX(y, page->nodes[j].y);
+            remaining -= MIN(remaining, page->nodes[j].width);
+        }
+
+        if (y + height > atlas->page_height) { continue; }
+
+        u32 top = y + height;
+        if (top < best_top || (top == best_top && page->nodes[i].width < best_width)) {
+            best_node = i;
+            best_top = top;
+            best_width = page->nodes[i].width;
+            best_y = y;
+        }
+    }
+
+    if (best_node == ~(u32)0) { return false; }
+
+    *out_node = best_node;
+    *out_y = best_y;
+
+    return true;
+}
+
+void _tt_atlas_skyline_add(
+    tt_atlas_page* page, u32 node, u32 width, u32 top
+) {
+    u32 x = page->nodes[node].x;
+    u32 end = x + width;
+
+    // Nodes under the rect are removed, and the last one may be shortened
+    u32 last = node;
+    while (last < page->num_nodes && page->nodes[last].x + page->nodes[last].width <= end) {
+        last++;
+    }
+
+    if (last < page->num_nodes && page->nodes[last].x < end) {
+        u32 shrink = end - page->nodes[last].x;
+        page->nodes[last].x += shrink;
+        page->nodes[last].width -= shrink;
+    }
+
+    u32 num_removed = last - node;
+    if (num_removed != 1) {
+        memmove(
+            &page->nodes[node + 1], &page->nodes[last],
+            sizeof(_tt_atlas_skyline_node) * (page->num_nodes - last)
+        );
+        page->num_nodes = page->num_nodes + 1 - num_removed;
+    }
+
+    page->nodes[node] = (_tt_atlas_skyline_node){ x, top, width };
+
+    // Merging neighbours at the same height
+    u32 i = node > 0 ? node - 1 : 0;
+    while (i + 1 < page->num_nodes && i <= node + 1) {
+        if (page->nodes[i].y == page->nodes[i + 1].y) {
+            page->nodes[i].width += page->nodes[i + 1].width;
+
+            memmove(
+                &page->nodes[i + 1], &page->nodes[i + 2],
+                sizeof(_tt_atlas_skyline_node) * (page->num_nodes - i - 2)
+            );
+            page->num_nodes--;
+        } else {
+            i++;
+        }
+    }
+}
+
+b32 _tt_atlas_rect_overlaps(tt_atlas_rect a, tt_atlas_rect b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width &&
+        a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+tt_atlas_rect _tt_atlas_rect_union(tt_atlas_rect a, tt_atlas_rect b) {
+    u32 x0 = MIN(a.x, b.x);
+    u32 y0 = MIN(a.y, b.y);
+    u32 x1 = MAX(a.x + a.width, b.x + b.width);
+    u32 y1 = MAX(a.y + a.height, b.y + b.height);
+
+    return (tt_atlas_rect){ x0, y0, x1 - x0, y1 - y0 };
+}
+
+u64 _tt_atlas_rect_area(tt_atlas_rect r) {
+    return (u64)r.width * r.height;
+}
+
+void _tt_atlas_mark_dirty(tt_atlas_page* page, tt_atlas_rect rect) {
+    // Slots never overlap, but a merged rect can cover free space
+    // that a later slot is put in
+    u32 best = ~(u32)0;
+    for (u32 i = 0; i < page->num_dirty_rects; i++) {
+        if (_tt_atlas_rect_overlaps(page->dirty_rects[i], rect)) {
+            best = i;
+            break;
+        }
+    }
+
+    if (best == ~(u32)0 && page->num_dirty_rects < TT_ATLAS_MAX_DIRTY_RECTS) {
+        page->dirty_rects[page->num_dirty_rects++] = rect;
+        return;
+    }
+
+    if (best == ~(u32)0) {
+        // Merging into the rect that grows the least
+        u64 best_growth = ~(u64)0;
+        for (u32 i = 0; i < page->num_dirty_rects; i++) {
+            u64 growth = _tt_atlas_rect_area(_tt_atlas_rect_union(page->dirty_rects[i], rect)) -
+                _tt_atlas_rect_area(page->dirty_rects[i]);
+
+            if (growth < best_growth) {
+                best = i;
+                best_growth = growth;
+            }
+        }
+    }
+
+    tt_atlas_rect merged = _tt_atlas_rect_union(page->dirty_rects[best], rect);
+
+    // The merged rect can now overlap others, which are absorbed into it
+    // until none are left, so the rects stay disjoint
+    b32 absorbed = true;
+    while (absorbed) {
+        absorbed = false;
+
+        for (u32 i = 0; i < page->num_dirty_rects; i++) {
+            if (i == best || !_tt_atlas_rect_overlaps(merged, page->dirty_rects[i])) {
+                continue;
+            }
+
+            merged = _tt_atlas_rect_union(merged, page->dirty_rects[i]);
+
+            u32 last = page->num_dirty_rects - 1;
+            page->dirty_rects[i] = page->dirty_rects[last];
+            if (best == last) { best = i; }
+            page->num_dirty_rects--;
+
+            absorbed = true;
+            break;
+        }
+    }
+
+    page->dirty_rects[best] = merged;
+}
+
+// Finds room for a `width` by `height` slot, using a new page if there is
+// one left, then evicting the least recently used page
+// Returns NULL if every page has been used this frame
+tt_atlas_page* _tt_atlas_alloc(
+    tt_atlas* atlas, u32 width, u32 height, u32* out_node, u32* out_y
+) {
+    for (u32 i = 0; i < atlas->num_pages; i++) {
+        tt_atlas_page* page = &atlas->pages[i];
+
+        if (_tt_atlas_skyline_fit(atlas, page, width, height, out_node, out_y)) {
+            return page;
+        }
+    }
+
+    tt_atlas_page* page = NULL;
+
+    if (atlas->num_pages < atlas->max_pages) {
+        page = &atlas->pages[atlas->num_pages++];
+
+        u64 page_size = (u64)atlas->page_width * atlas->page_height * atlas->bytes_per_pixel;
+        page->data = PUSH_ARRAY(atlas->arena, u8, page_size);
+        page->nodes = PUSH_ARRAY_NZ(atlas->arena, _tt_atlas_skyline_node, atlas->page_width);
+
+        _tt_atlas_page_reset(atlas, page);
+    } else {
+        for (u32 i = 0; i < atlas->num_pages; i++) {
+            tt_atlas_page* cur = &atlas->pages[i];
+
+            if (
+                cur->last_used_frame < atlas->frame &&
+                (page == NULL || cur->last_used_frame < page->last_used_frame)
+            ) {
+                page = cur;
+            }
+        }
+
+        if (page == NULL) { return NULL; }
+
+        _tt_atlas_page_evict(atlas, page);
+    }
+
+    // An empty page always fits the slot, as the size was checked before
+    *out_node = 0;
+    *out_y = 0;
+
+    return page;
+}
+
+tt_atlas_entry* tt_atlas_insert(
+    tt_atlas* atlas, const tt_font_info* font,
+    u32 glyph_index, u32 variant,
+    const u8* pixels, u32 width, u32 height
+) {
+    if (pixels == NULL) {
+        width = 0;
+        height = 0;
+    }
+
+    u32 slot_width = width + atlas->padding;
+    u32 slot_height = height + atlas->padding;
+
+    if (slot_width > atlas->page_width || slot_height > atlas->page_height) {
+        atlas->failed_inserts++;
+        return NULL;
+    }
+
+    tt_atlas_page* page = NULL;
+    u32 node = 0;
+    u32 y = 0;
+
+    // Empty glyphs take no space, and are kept in the first page
+    if (slot_width == 0 || slot_height == 0) {
+        if (atlas->num_pages == 0) {
+            page = _tt_atlas_alloc(atlas, 1, 1, &node, &y);
+        } else {
+            page = &atlas->pages[0];
+        }
+    } else {
+        page = _tt_atlas_alloc(atlas, slot_width, slot_height, &node, &y);
+    }
+
+    if (page == NULL) {
+        atlas->failed_inserts++;
+        return NULL;
+    }
+
+    u32 page_index = (u32)(page - atlas->pages);
+    tt_atlas_rect slot = { 0, 0, 0, 0 };
+
+    if (slot_width != 0 && slot_height != 0) {
+        slot = (tt_atlas_rect){ page->nodes[node].x, y, slot_width, slot_height };
+
+        _tt_atlas_skyline_add(page, node, slot_width, y + slot_height);
+
+        // Padding is cleared, since the slot may hold an evicted glyph
+        u32 bpp = atlas->bytes_per_pixel;
+        u64 stride = (u64)atlas->page_width * bpp;
+
+        for (u32 row = 0; row < slot_height; row++) {
+            u8* dst = page->data + (slot.y + row) * stride + (u64)slot.x * bpp;
+
+            if (row < height) {
+                memcpy(dst, pixels + (u64)row * width * bpp, (u64)width * bpp);
+                memset(dst + (u64)width * bpp, 0, (u64)atlas->padding * bpp);
+            } else {
+                memset(dst, 0, (u64)slot_width * bpp);
+            }
+        }
+
+        page->used_pixels += (u64)slot_width * slot_height;
+
+        _tt_atlas_mark_dirty(page, slot);
+    }
+
+    tt_atlas_entry* entry = atlas->free_entries;
+    if (entry != NULL) {
+        SLL_STACK_POP(atlas->free_entries);
+    } else {
+        entry = PUSH_STRUCT_NZ(atlas->arena, tt_atlas_entry);
+    }
+
+    *entry = (tt_atlas_entry){
+        .font = font,
+        .glyph_index = glyph_index,
+        .variant = variant,
+        .page = page_index,
+        .rect = { slot.x, slot.y, width, height },
+    };
+
+    u32 bucket = _tt_atlas_hash(font, glyph_index, variant) & (atlas->num_buckets - 1);
+    entry->hash_next = atlas->buckets[bucket];
+    atlas->buckets[bucket] = entry;
+
+    SLL_STACK_PUSH(page->entries, entry);
+    page->num_entries++;
+    page->last_used_frame = atlas->frame;
+
+    return entry;
+}
+
+const tt_atlas_rect* tt_atlas_dirty_rects(
+    const tt_atlas* atlas, u32 page, u32* num_rects
+) {
+    if (page >= atlas->num_pages) {
+        *num_rects = 0;
+        return NULL;
+    }
+
+    *num_rects = atlas->pages[page].num_dirty_rects;
+
+    return atlas->pages[page].dirty_rects;
+}
+
+tt_atlas_stats tt_atlas_get_stats(const tt_atlas* atlas) {
+    tt_atlas_stats stats = {
+        .num_pages = atlas->num_pages,
+        .total_pixels = (u64)atlas->page_width * atlas->page_height * atlas->num_pages,
+        .hits = atlas->hits,
+        .misses = atlas->misses,
+        .evicted_glyphs = atlas->evicted_glyphs,
+        .evicted_pages = atlas->evicted_pages,
+        .failed_inserts = atlas->failed_inserts,
+    };
+
+    for (u32 i = 0; i < atlas->num_pages; i++) {
+        stats.num_glyphs += atlas->pages[i].num_entries;
+        stats.used_pixels += atlas->pages[i].used_pixels;
+    }
+
+    if (stats.total_pixels) {
+        stats.occupancy = (f32)((f64)stats.used_pixels / (f64)stats.total_pixels);
+    }
+
+    return stats;
+}
+
+void tt_atlas_clear(tt_atlas* atlas) {
+    for (u32 i = 0; i < atlas->num_pages; i++) {
+        _tt_atlas_page_evict(atlas, &atlas->pages[i]);
+    }
+
+    atlas->hits = 0;
+    atlas->misses = 0;
+    atlas->evicted_glyphs = 0;
+    atlas->evicted_pages = 0;
+    atlas->failed_inserts = 0;
+}
+
@@ -0,0 +1,150 @@
+
+// Max number of dirty rectangles kept per page and per frame
+// Past this, new rectangles are merged into existing ones
+#define TT_ATLAS_MAX_DIRTY_RECTS 16
+
+typedef enum {
+    TT_ATLAS_FORMAT_R8 = 0,
+    TT_ATLAS_FORMAT_RGB8,
+} tt_atlas_format;
+
+typedef struct {
+    u32 x, y;
+    u32 width, height;
+} tt_atlas_rect;
+
+typedef struct tt_atlas_entry {
+    // Next entry in the same hash bucket
+    struct tt_atlas_entry* hash_next;
+    // Next entry in the same page
+    struct tt_atlas_entry* next;
+
+    const tt_font_info* font;
+    u32 glyph_index;
+    // Set by the caller to tell apart renders of the same glyph
+    // (e.g. pixel size or render mode)
+    u32 variant;
+
+    u32 page;
+    // Area of the glyph in the page, without padding
+    tt_atlas_rect rect;
+} tt_atlas_entry;
+
+typedef struct {
+    u32 x, y, width;
+} _tt_atlas_skyline_node;
+
+typedef struct {
+    // NULL until the page is first used
+    u8* data;
+
+    // Sorted by x, and covering the width of the page
+    u32 num_nodes;
+    _tt_atlas_skyline_node* nodes;
+
+    tt_atlas_entry* entries;
+    u32 num_entries;
+    // Pixels taken by entries, including padding
+    u64 used_pixels;
+
+    // Frame in which a glyph of the page was last looked up or inserted
+    // Pages are evicted as a whole, from the least recently used one
+    u64 last_used_frame;
+
+    u32 num_dirty_rects;
+    tt_atlas_rect dirty_rects[TT_ATLAS_MAX_DIRTY_RECTS];
+} tt_atlas_page;
+
+typedef struct {
+    mem_arena* arena;
+
+    tt_atlas_format format;
+    u32 bytes_per_pixel;
+
+    u32 page_width;
+    u32 page_height;
+    // Empty pixels kept on the right and bottom of every glyph,
+    // so glyphs can be sampled with bilinear filtering
+    u32 padding;
+
+    u32 max_pages;
+    u32 num_pages;
+    tt_atlas_page* pages;
+
+    // Always a power of two
+    u32 num_buckets;
+    tt_atlas_entry** buckets;
+
+    tt_atlas_entry* free_entries;
+
+    u64 frame;
+
+    u64 hits;
+    u64 misses;
+    u64 evicted_glyphs;
+    u64 evicted_pages;
+    // Inserts that found no room, even after evicting
+    u64 failed_inserts;
+} tt_atlas;
+
+typedef struct {
+    u32 num_pages;
+    u32 num_glyphs;
+
+    u64 used_pixels;
+    // Pixels of every page that has been used
+    u64 total_pixels;
+    // `used_pixels / total_pixels`, or 0 if no page is used
+    f32 occupancy;
+
+    u64 hits;
+    u64 misses;
+    u64 evicted_glyphs;
+    u64 evicted_pages;
+    u64 failed_inserts;
+} tt_atlas_stats;
+
+// Pages are `page_width` by `page_height` pixels of `format`,
+// and are allocated on `arena` when first needed
+// The arena should not be cleared or popped while the atlas is in use
+tt_atlas* tt_atlas_create(
+    mem_arena* arena, tt_atlas_format format,
+    u32 page_width, u32 page_height, u32 max_pages,
+    u32 padding, u32 num_buckets
+);
+
+// Starts a new frame and clears the dirty rectangles of every page
+// Glyphs used during the current frame are never evicted, so pages can
+// only be evicted once this has been called
+void tt_atlas_frame_begin(tt_atlas* atlas);
+
+// Returns NULL if the glyph is not in the atlas
+// Returned pointers stay valid until the next call to `tt_atlas_insert`
+tt_atlas_entry* tt_atlas_find(
+    tt_atlas* atlas, const tt_font_info* font,
+    u32 glyph_index, u32 variant
+);
+
+// Copies `width` by `height` pixels of the atlas' format into a page,
+// evicting the least recently used page if every page is full
+// `pixels` can be NULL for empty glyphs, which are given an empty rect
+// Returns NULL if the glyph does not fit in a page, or if every page
+// has glyphs used during the current frame
+tt_atlas_entry* tt_atlas_insert(
+    tt_atlas* atlas, const tt_font_info* font,
+    u32 glyph_index, u32 variant,
+    const u8* pixels, u32 width, u32 height
+);
+
+// Rectangles of `page` written to since `tt_atlas_frame_begin`
+// Rectangles do not overlap, so each one can be uploaded on its own
+const tt_atlas_rect* tt_atlas_dirty_rects(
+    const tt_atlas* atlas, u32 page, u32* num_rects
+);
+
+tt_atlas_stats tt_atlas_get_stats(const tt_atlas* atlas);
+
+// Evicts every glyph and resets the counters
+// Page memory is kept for reuse by the atlas
+void tt_atlas_clear(tt_atlas* atlas);
+
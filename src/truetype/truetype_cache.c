@@ -0,0 +1,297 @@
+
+u64 _tt_glyph_cache_block_size(u32 block_class) {
+    return (u64)1 << (block_class + TT_GLYPH_CACHE_MIN_BLOCK_LOG2);
+}
+
+void _tt_glyph_cache_free_push(tt_glyph_cache* cache, u64 offset, u32 block_class) {
+    _tt_glyph_cache_block* block = (_tt_glyph_cache_block*)(cache->pool + offset);
+    _tt_glyph_cache_block* first = cache->free_blocks[block_class];
+
+    block->next = first;
+    block->prev = NULL;
+    if (first != NULL) { first->prev = block; }
+    cache->free_blocks[block_class] = block;
+
+    cache->free_classes[offset >> TT_GLYPH_CACHE_MIN_BLOCK_LOG2] = (u8)(block_class + 1);
+}
+
+void _tt_glyph_cache_free_remove(tt_glyph_cache* cache, u64 offset, u32 block_class) {
+    _tt_glyph_cache_block* block = (_tt_glyph_cache_block*)(cache->pool + offset);
+
+    if (block->prev != NULL) {
+        block->prev->next = block->next;
+    } else {
+        cache->free_blocks[block_class] = block->next;
+    }
+    if (block->next != NULL) { block->next->prev = block->prev; }
+
+    cache->free_classes[offset >> TT_GLYPH_CACHE_MIN_BLOCK_LOG2] = 0;
+}
+
+// Returns NULL if no free block is large enough
+u8* _tt_glyph_cache_block_alloc(tt_glyph_cache* cache, u32 block_class) {
+    u32 free_class = block_class;
+    while (free_class <= cache->root_class && cache->free_blocks[free_class] == NULL) {
+        free_class++;
+    }
+
+    if (free_class > cache->root_class) { return NULL; }
+
+    u64 offset = (u64)((u8*)cache->free_blocks[free_class] - cache->pool);
+    _tt_glyph_cache_free_remove(cache, offset, free_class);
+
+    // Splitting down to the requested class, freeing the upper halves
+    while (free_class > block_class) {
+        free_class--;
+        _tt_glyph_cache_free_push(
+            cache, offset + _tt_glyph_cache_block_size(free_class), free_class
+        );
+    }
+
+    return cache->pool + offset;
+}
+
+void _tt_glyph_cache_block_free(tt_glyph_cache* cache, u8* block, u32 block_class) {
+    u64 offset = (u64)(block - cache->pool);
+
+    // Root blocks start at multiples of their size,
+    // so a block's buddy only differs in the bit of its size
+    while (block_class < cache->root_class) {
+        u64 buddy = offset ^ _tt_glyph_cache_block_size(block_class);
+
+        if (
+            buddy >= cache->pool_size ||
+            cache->free_classes[buddy >> TT_GLYPH_CACHE_MIN_BLOCK_LOG2] != block_class + 1
+        ) {
+            break;
+        }
+
+        _tt_glyph_cache_free_remove(cache, buddy, block_class);
+        offset = MIN(offset, buddy);
+        block_class++;
+    }
+
+    _tt_glyph_cache_free_push(cache, offset, block_class);
+}
+
+tt_glyph_cache* tt_glyph_cache_create(
+    mem_arena* arena, u64 memory_budget, u32 num_buckets
+) {
+    // Rounding up to a power of two so the hash can be masked
+    u32 buckets_pow2 = 1;
+    while (buckets_pow2 < num_buckets) {
+        buckets_pow2 <<= 1;
+    }
+
+    tt_glyph_cache* cache = PUSH_STRUCT(arena, tt_glyph_cache);
+
+    cache->arena = arena;
+    cache->memory_budget = memory_budget;
+    cache->num_buckets = buckets_pow2;
+    cache->buckets = PUSH_ARRAY(arena, tt_glyph_cache_entry*, buckets_pow2);
+
+    // Largest class that fits in the budget, which the pool is split into
+    u32 root_class = 0;
+    while (
+        root_class < TT_GLYPH_CACHE_NUM_BLOCK_CLASSES - 1 &&
+        _tt_glyph_cache_block_size(root_class + 1) <= memory_budget
+    ) {
+        root_class++;
+    }
+
+    u64 min_size = _tt_glyph_cache_block_size(0);
+
+    cache->root_class = root_class;
+    cache->pool_size = MAX(memory_budget, min_size) / min_size * min_size;
+    cache->pool = PUSH_ARRAY_NZ(arena, u8, cache->pool_size);
+    cache->free_classes = PUSH_ARRAY(
+        arena, u8, cache->pool_size >> TT_GLYPH_CACHE_MIN_BLOCK_LOG2
+    );
+
+    // Blocks of the root class, then the rest of the pool split by
+    // its binary digits, largest first, so every block starts at a
+    // multiple of its size and merges never cross into the next one
+    u64 offset = 0;
+    for (u32 i = root_class + 1; i-- > 0;) {
+        u64 size = _tt_glyph_cache_block_size(i);
+
+        while (cache->pool_size - offset >= size) {
+            _tt_glyph_cache_free_push(cache, offset, i);
+            offset += size;
+
+            if (i != root_class) { break; }
+        }
+    }
+
+    return cache;
+}
+
+u32 _tt_glyph_cache_hash(const tt_font_info* font, u32 glyph_index) {
+    u64 h = (u64)(uintptr_t)font;
+    h ^= (u64)glyph_index * 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ULL;
+    h ^= h >> 32;
+
+    return (u32)h;
+}
+
+u32 _tt_glyph_cache_block_class(u64 size) {
+    u32 block_class = 0;
+
+    while (
+        block_class < TT_GLYPH_CACHE_NUM_BLOCK_CLASSES - 1 &&
+        ((u64)1 << (block_class + TT_GLYPH_CACHE_MIN_BLOCK_LOG2)) < size
+    ) {
+        block_class++;
+    }
+
+    return block_class;
+}
+
+void _tt_glyph_cache_evict(tt_glyph_cache* cache, tt_glyph_cache_entry* entry) {
+    u32 bucket = _tt_glyph_cache_hash(entry->font, entry->glyph_index) &
+        (cache->num_buckets - 1);
+
+    tt_glyph_cache_entry** link = &cache->buckets[bucket];
+    while (*link != entry) {
+        link = &(*link)->hash_next;
+    }
+    *link = entry->hash_next;
+
+    DLL_REMOVE(cache->lru_first, cache->lru_last, entry);
+
+    if (entry->segments != NULL && entry->block_class <= cache->root_class) {
+        _tt_glyph_cache_block_free(cache, (u8*)entry->segments, entry->block_class);
+
+        cache->memory_used -= _tt_glyph_cache_block_size(entry->block_class);
+    }
+
+    SLL_STACK_PUSH(cache->free_entries, entry);
+
+    cache->num_entries--;
+    cache->evictions++;
+}
+
+tt_glyph_cache_entry* tt_glyph_cache_get_entry(
+    tt_glyph_cache* cache, string8 file,
+    tt_font_info* info, u32 glyph_index
+) {
+    if (info == NULL || !info->initialized) { return NULL; }
+
+    u32 bucket = _tt_glyph_cache_hash(info, glyph_index) & (cache->num_buckets - 1);
+
+    for (
+        tt_glyph_cache_entry* entry = cache->buckets[bucket];
+        entry != NULL; entry = entry->hash_next
+    ) {
+        if (entry->font == info && entry->glyph_index == glyph_index) {
+            // Moving to the back of the LRU list
+            DLL_REMOVE(cache->lru_first, cache->lru_last, entry);
+            DLL_PUSH_BACK(cache->lru_first, cache->lru_last, entry);
+
+            cache->hits++;
+
+            return entry;
+        }
+    }
+
+    cache->misses++;
+
+    mem_arena_temp scratch = arena_scratch_get(&cache->arena, 1);
+
+    tt_glyph_data glyph = tt_glyph_data_from_index(
+        scratch.arena, file, info, glyph_index
+    );
+    tt_glyph_color_edges(&glyph);
+
+    // Segments, then points, then flags, so each stays aligned
+    u64 segments_size = (u64)glyph.num_segments * sizeof(tt_segment);
+    u64 data_size = segments_size +
+        (u64)glyph.num_points * (sizeof(v2_i16) + sizeof(tt_point_flag));
+    u32 block_class = _tt_glyph_cache_block_class(data_size);
+    u64 block_size = data_size ? _tt_glyph_cache_block_size(block_class) : 0;
+
+    u8* block = NULL;
+
+    if (block_size && block_class <= cache->root_class) {
+        // Evicting every glyph frees the whole pool, so this always ends
+        while ((block = _tt_glyph_cache_block_alloc(cache, block_class)) == NULL) {
+            _tt_glyph_cache_evict(cache, cache->lru_first);
+        }
+
+        cache->memory_used += block_size;
+    } else if (block_size) {
+        block = PUSH_ARRAY_NZ(cache->arena, u8, block_size);
+    }
+
+    tt_glyph_cache_entry* entry = cache->free_entries;
+    if (entry != NULL) {
+        SLL_STACK_POP(cache->free_entries);
+    } else {
+        entry = PUSH_STRUCT_NZ(cache->arena, tt_glyph_cache_entry);
+    }
+
+    *entry = (tt_glyph_cache_entry){
+        .font = info,
+        .glyph_index = glyph_index,
+        .block_class = block_class,
+        .glyph = glyph,
+    };
+
+    if (block != NULL) {
+        entry->segments = (tt_segment*)block;
+        entry->glyph.points = (v2_i16*)(block + segments_size);
+        entry->glyph.flags = (tt_point_flag*)(
+            block + segments_size + sizeof(v2_i16) * glyph.num_points
+        );
+
+        memcpy(entry->glyph.points, glyph.points, sizeof(v2_i16) * glyph.num_points);
+        memcpy(entry->glyph.flags, glyph.flags, sizeof(tt_point_flag) * glyph.num_points);
+
+        tt_glyph_segments(&entry->glyph, (v2_f32){ 1.0f, 1.0f }, (v2_f32){ 0 }, entry->segments);
+    } else {
+        entry->segments = NULL;
+        entry->glyph.points = NULL;
+        entry->glyph.flags = NULL;
+    }
+
+    arena_scratch_release(scratch);
+
+    entry->hash_next = cache->buckets[bucket];
+    cache->buckets[bucket] = entry;
+
+    DLL_PUSH_BACK(cache->lru_first, cache->lru_last, entry);
+
+    cache->num_entries++;
+
+    return entry;
+}
+
+tt_glyph_data* tt_glyph_cache_get(
+    tt_glyph_cache* cache, string8 file,
+    tt_font_info* info, u32 glyph_index
+) {
+    tt_glyph_cache_entry* entry = tt_glyph_cache_get_entry(cache, file, info, glyph_index);
+
+    return entry == NULL ? NULL : &entry->glyph;
+}
+
+tt_glyph_data* tt_glyph_cache_get_codepoint(
+    tt_glyph_cache* cache, string8 file,
+    tt_font_info* info, u32 codepoint
+) {
+    u32 index = tt_glyph_index(file, info, codepoint);
+    return tt_glyph_cache_get(cache, file, info, index);
+}
+
+void tt_glyph_cache_clear(tt_glyph_cache* cache) {
+    while (cache->lru_first != NULL) {
+        _tt_glyph_cache_evict(cache, cache->lru_first);
+    }
+
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+}
+
@@ -0,0 +1,99 @@
+
+// Smallest block (in bytes) handed out for glyph data
+// Block sizes are powers of two from this up to 2^(min + classes - 1)
+#define TT_GLYPH_CACHE_MIN_BLOCK_LOG2 6
+#define TT_GLYPH_CACHE_NUM_BLOCK_CLASSES 20
+
+typedef struct tt_glyph_cache_entry {
+    // Next entry in the same hash bucket
+    struct tt_glyph_cache_entry* hash_next;
+
+    // Least recently used list
+    // The front of the list is evicted first
+    struct tt_glyph_cache_entry* next;
+    struct tt_glyph_cache_entry* prev;
+
+    const tt_font_info* font;
+    u32 glyph_index;
+
+    u32 block_class;
+
+    tt_glyph_data glyph;
+    // `glyph.num_segments` segments in font units, from `tt_glyph_segments`
+    // Stored at the start of the entry's block, before the points and flags
+    tt_segment* segments;
+} tt_glyph_cache_entry;
+
+// Free block of the pool, linked into the free list of its class
+typedef struct _tt_glyph_cache_block {
+    struct _tt_glyph_cache_block* next;
+    struct _tt_glyph_cache_block* prev;
+} _tt_glyph_cache_block;
+
+typedef struct {
+    mem_arena* arena;
+
+    // Size of the pool glyph data is stored in, which is pushed
+    // onto the arena once and never grows past it
+    u64 memory_budget;
+    // Bytes of pool blocks currently in use by entries
+    u64 memory_used;
+
+    // Buddy allocator over the pool. Freed blocks are merged with their
+    // buddy, so any mix of glyph sizes fits once enough glyphs are evicted
+    u8* pool;
+    u64 pool_size;
+    // Largest class the pool is split into, blocks never merge past it
+    // Glyphs needing a larger block are pushed onto the arena directly,
+    // and that memory is not reused once they are evicted
+    u32 root_class;
+    // Class + 1 of the free block starting at each min block sized unit,
+    // 0 if no free block starts there
+    u8* free_classes;
+
+    // Always a power of two
+    u32 num_buckets;
+    tt_glyph_cache_entry** buckets;
+
+    u32 num_entries;
+
+    tt_glyph_cache_entry* lru_first;
+    tt_glyph_cache_entry* lru_last;
+
+    tt_glyph_cache_entry* free_entries;
+    _tt_glyph_cache_block* free_blocks[TT_GLYPH_CACHE_NUM_BLOCK_CLASSES];
+
+    u64 hits;
+    u64 misses;
+    u64 evictions;
+} tt_glyph_cache;
+
+// Glyphs are parsed and edge colored once, then kept in memory from `arena`
+// `memory_budget` bytes are pushed onto the arena up front
+// The arena should not be cleared or popped while the cache is in use
+tt_glyph_cache* tt_glyph_cache_create(
+    mem_arena* arena, u64 memory_budget, u32 num_buckets
+);
+
+// Returned pointers stay valid until the glyph is evicted,
+// which can only happen during a later call that misses the cache
+// Returns NULL if the font is not initialized
+tt_glyph_data* tt_glyph_cache_get(
+    tt_glyph_cache* cache, string8 file,
+    tt_font_info* info, u32 glyph_index
+);
+// Same as `tt_glyph_cache_get`, but returns the whole entry,
+// for the segments that were built when the glyph was cached
+tt_glyph_cache_entry* tt_glyph_cache_get_entry(
+    tt_glyph_cache* cache, string8 file,
+    tt_font_info* info, u32 glyph_index
+);
+tt_glyph_data* tt_glyph_cache_get_codepoint(
+    tt_glyph_cache* cache, string8 file,
+    tt_font_info* info, u32 codepoint
+);
+
+// Evicts every glyph and resets the counters
+// Memory is kept for reuse by the cache
+void tt_glyph_cache_clear(tt_glyph_cache* cache);
+
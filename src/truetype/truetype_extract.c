@@ -0,0 +1,158 @@
+
+// Glyphs are split into jobs of this many glyphs, small enough that
+// expensive ranges of the font (e.g. CJK) are spread out between threads
+#define _TT_EXTRACT_BLOCK_SIZE 64
+
+typedef struct {
+    string8 file;
+    tt_font_info* info;
+
+    tt_glyph_blob* blob;
+
+    u32 block_start;
+    u32 block_end;
+
+    u32 num_failed;
+} _tt_extract_work;
+
+void _tt_extract_count(void* arg) {
+    _tt_extract_work* work = (_tt_extract_work*)arg;
+
+    string8 file = work->file;
+    tt_font_info* info = work->info;
+    tt_glyph_blob* blob = work->blob;
+
+    for (u32 i = work->block_start; i < work->block_end; i++) {
+        tt_glyph_data* glyph = &blob->glyphs[i];
+        *glyph = (tt_glyph_data){ 0 };
+
+        _tt_glyf_entry entry = _tt_find_glyf_entry(file, info, i);
+
+        // Empty glyphs (e.g. spaces) have no entry
+        if (entry.length == 0) { continue; }
+
+        _tt_glyph_counts counts = { 0 };
+        if (
+            entry.length < 10 ||
+            !_tt_glyph_count(file, info, &counts, i, 0)
+        ) {
+            work->num_failed++;
+            continue;
+        }
+
+        u8* glyf_data = file.str + info->glyf.offset + entry.offset;
+
+        glyph->x_min = (i16)_TT_READ_BE16(glyf_data + 2);
+        glyph->y_min = (i16)_TT_READ_BE16(glyf_data + 4);
+        glyph->x_max = (i16)_TT_READ_BE16(glyf_data + 6);
+        glyph->y_max = (i16)_TT_READ_BE16(glyf_data + 8);
+
+        glyph->num_contours = counts.num_contours;
+        glyph->num_segments = counts.num_segments;
+        glyph->num_points = counts.num_points;
+    }
+}
+
+void _tt_extract_decode(void* arg) {
+    _tt_extract_work* work = (_tt_extract_work*)arg;
+
+    tt_glyph_blob* blob = work->blob;
+
+    for (u32 i = work->block_start; i < work->block_end; i++) {
+        tt_glyph_data* glyph = &blob->glyphs[i];
+
+        u32 num_points = glyph->num_points;
+        if (num_points == 0) { continue; }
+
+        u8* glyph_data = blob->data + blob->offsets[i];
+
+        glyph->flags = glyph_data;
+        glyph->points = (v2_i16*)(glyph_data + ALIGN_UP_POW2(num_points, 4));
+        glyph->num_points = 0;
+
+        if (
+            !_tt_glyph_decode(work->file, work->info, glyph, i, num_points, 0) ||
+            glyph->num_points != num_points
+        ) {
+            *glyph = (tt_glyph_data){ 0 };
+            work->num_failed++;
+        }
+    }
+}
+
+tt_glyph_blob tt_font_extract_all(
+    mem_arena* arena, string8 file,
+    tt_font_info* info, plat_job_system* job_system
+) {
+    if (info == NULL || !info->initialized) { return (tt_glyph_blob){ 0 }; }
+
+    u32 num_blocks = ((u32)info->num_glyphs + _TT_EXTRACT_BLOCK_SIZE - 1) / _TT_EXTRACT_BLOCK_SIZE;
+
+    mem_arena_temp maybe_temp = arena_temp_begin(arena);
+
+    tt_glyph_blob blob = {
+        .num_glyphs = info->num_glyphs,
+        .offsets = PUSH_ARRAY_NZ(arena, u32, info->num_glyphs + 1),
+        .glyphs = PUSH_ARRAY_NZ(arena, tt_glyph_data, info->num_glyphs),
+    };
+
+    mem_arena_temp scratch = arena_scratch_get(&arena, 1);
+
+    _tt_extract_work* works = PUSH_ARRAY(scratch.arena, _tt_extract_work, num_blocks);
+
+    for (u32 i = 0; i < num_blocks; i++) {
+        works[i] = (_tt_extract_work){
+            .file = file,
+            .info = info,
+            .blob = &blob,
+            .block_start = i * _TT_EXTRACT_BLOCK_SIZE,
+            .block_end = MIN(blob.num_glyphs, (i + 1) * _TT_EXTRACT_BLOCK_SIZE),
+        };
+    }
+
+    // Glyphs are counted first, so every glyph can be
+    // decoded straight to its final place in the blob
+    plat_job_counter counter = { 0 };
+    for (u32 i = 0; i < num_blocks; i++) {
+        plat_jobs_submit(job_system, _tt_extract_count, &works[i], &counter);
+    }
+    plat_jobs_wait(job_system, &counter);
+
+    u64 data_size = 0;
+    for (u32 i = 0; i < blob.num_glyphs; i++) {
+        u32 num_points = blob.glyphs[i].num_points;
+
+        blob.offsets[i] = (u32)data_size;
+        data_size += ALIGN_UP_POW2(num_points, 4) + (u64)num_points * sizeof(v2_i16);
+
+        if (data_size > (u32)~0) {
+            error_emit("TTF glyph data is too large to extract");
+
+            arena_scratch_release(scratch);
+            arena_temp_end(maybe_temp);
+
+            return (tt_glyph_blob){ 0 };
+        }
+    }
+    blob.offsets[blob.num_glyphs] = (u32)data_size;
+
+    blob.data = PUSH_ARRAY_NZ(arena, u8, data_size);
+
+    for (u32 i = 0; i < num_blocks; i++) {
+        plat_jobs_submit(job_system, _tt_extract_decode, &works[i], &counter);
+    }
+    plat_jobs_wait(job_system, &counter);
+
+    for (u32 i = 0; i < num_blocks; i++) {
+        blob.num_failed += works[i].num_failed;
+    }
+
+    arena_scratch_release(scratch);
+
+    if (blob.num_failed > 0) {
+        error_emitf("Failed to parse %u TTF glyphs", blob.num_failed);
+    }
+
+    return blob;
+}
+
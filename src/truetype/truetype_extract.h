@@ -0,0 +1,28 @@
+
+// Glyph data of a whole font, packed into one contiguous buffer
+// Each glyph is laid out as its flags, padded to a multiple of 4 bytes,
+// followed by its points in font units, so the points stay aligned
+// Segments for the renderer are built from these with `tt_glyph_segments`
+typedef struct {
+    u32 num_glyphs;
+
+    // Glyph `i` starts at `data + offsets[i]`
+    // `offsets[num_glyphs]` is the total size of `data`
+    u32* offsets;
+    u8* data;
+
+    // The flags and points of each glyph point into `data`
+    // Glyphs that failed to parse are left empty
+    tt_glyph_data* glyphs;
+
+    u32 num_failed;
+} tt_glyph_blob;
+
+// Parses every glyph in the font, with blocks of glyphs submitted as jobs
+// to `job_system` (or parsed on the calling thread if it is NULL)
+// Everything is allocated on `arena`
+tt_glyph_blob tt_font_extract_all(
+    mem_arena* arena, string8 file,
+    tt_font_info* info, plat_job_system* job_system
+);
+
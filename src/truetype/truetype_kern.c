@@ -0,0 +1,780 @@
+
+// Pairs are collected into a growable map on a scratch arena,
+// then packed into the final table
+typedef struct {
+    mem_arena* arena;
+
+    u32 capacity;
+    u32 count;
+    u32 hash_shift;
+
+    u32* keys;
+    i32* values;
+} _tt_kern_map;
+
+u32 _tt_kern_hash(u32 key, u32 hash_shift) {
+    return (key * 0x9E3779B1u) >> hash_shift;
+}
+
+b32 _tt_kern_in_bounds(u32 length, u64 offset, u64 size) {
+    return offset + size <= length;
+}
+
+void _tt_kern_map_init(_tt_kern_map* map, mem_arena* arena, u32 capacity_log2) {
+    *map = (_tt_kern_map){
+        .arena = arena,
+        .capacity = (u32)1 << capacity_log2,
+        .hash_shift = 32 - capacity_log2,
+    };
+
+    map->keys = PUSH_ARRAY_NZ(arena, u32, map->capacity);
+    map->values = PUSH_ARRAY_NZ(arena, i32, map->capacity);
+
+    memset(map->keys, 0xff, sizeof(u32) * map->capacity);
+}
+
+// Returns the slot of `key`, which is empty if the key is not in the map
+u32 _tt_kern_map_slot(const _tt_kern_map* map, u32 key) {
+    u32 slot = _tt_kern_hash(key, map->hash_shift);
+
+    while (map->keys[slot] != key && map->keys[slot] != TT_KERN_EMPTY_KEY) {
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+
+    return slot;
+}
+
+void _tt_kern_map_grow(_tt_kern_map* map) {
+    _tt_kern_map old_map = *map;
+
+    _tt_kern_map_init(map, old_map.arena, 32 - old_map.hash_shift + 1);
+
+    for (u32 i = 0; i < old_map.capacity; i++) {
+        if (old_map.keys[i] == TT_KERN_EMPTY_KEY) { continue; }
+
+        u32 slot = _tt_kern_map_slot(map, old_map.keys[i]);
+        map->keys[slot] = old_map.keys[i];
+        map->values[slot] = old_map.values[i];
+        map->count++;
+    }
+}
+
+// Adds `value` to the pair if `add` is set, otherwise replaces it
+// Zero values are only written to pairs that are already in the map
+void _tt_kern_map_set(_tt_kern_map* map, u32 left, u32 right, i32 value, b32 add) {
+    u32 key = left << 16 | right;
+    u32 slot = _tt_kern_map_slot(map, key);
+
+    if (map->keys[slot] == key) {
+        map->values[slot] = add ? map->values[slot] + value : value;
+        return;
+    }
+
+    if (value == 0) { return; }
+
+    if ((map->count + 1) * 2 > map->capacity) {
+        _tt_kern_map_grow(map);
+        slot = _tt_kern_map_slot(map, key);
+    }
+
+    map->keys[slot] = key;
+    map->values[slot] = value;
+    map->count++;
+}
+
+// Sets the pair unless it is already in the map, even if `value` is zero
+void _tt_kern_map_insert(_tt_kern_map* map, u32 left, u32 right, i32 value) {
+    u32 key = left << 16 | right;
+    u32 slot = _tt_kern_map_slot(map, key);
+
+    if (map->keys[slot] == key) { return; }
+
+    if ((map->count + 1) * 2 > map->capacity) {
+        _tt_kern_map_grow(map);
+        slot = _tt_kern_map_slot(map, key);
+    }
+
+    map->keys[slot] = key;
+    map->values[slot] = value;
+    map->count++;
+}
+
+int _tt_kern_range_cmp(const void* a, const void* b) {
+    u16 start_a = ((const tt_kern_range*)a)->start;
+    u16 start_b = ((const tt_kern_range*)b)->start;
+
+    return (start_a > start_b) - (start_a < start_b);
+}
+
+// Returns the range containing `glyph`, or NULL
+const tt_kern_range* _tt_kern_range_find(const tt_kern_range* ranges, u32 count, u32 glyph) {
+    u32 lo = 0;
+    u32 hi = count;
+
+    while (lo < hi) {
+        u32 mid = lo + (hi - lo) / 2;
+
+        if (glyph < ranges[mid].start) {
+            hi = mid;
+        } else if (glyph > ranges[mid].end) {
+            lo = mid + 1;
+        } else {
+            return &ranges[mid];
+        }
+    }
+
+    return NULL;
+}
+
+u32 _tt_kern_range_class(const tt_kern_range* ranges, u32 count, u32 glyph) {
+    const tt_kern_range* range = _tt_kern_range_find(ranges, count, glyph);
+
+    return range == NULL ? 0 : range->value;
+}
+
+// Packs glyphs into sorted ranges of consecutive glyphs with the same value
+// `values` can be NULL, then every range has the value 0
+u32 _tt_kern_pack_ranges(
+    mem_arena* arena, const u16* glyphs, const u16* values,
+    u32 count, tt_kern_range** ranges
+) {
+    u32 num_ranges = 0;
+    for (u32 i = 0; i < count; i++) {
+        b32 extends = i > 0 && (u32)glyphs[i - 1] + 1 == glyphs[i] &&
+            (values == NULL || values[i - 1] == values[i]);
+
+        num_ranges += !extends;
+    }
+
+    *ranges = PUSH_ARRAY_NZ(arena, tt_kern_range, num_ranges);
+
+    u32 pos = 0;
+    for (u32 i = 0; i < count; i++) {
+        b32 extends = i > 0 && (u32)glyphs[i - 1] + 1 == glyphs[i] &&
+            (values == NULL || values[i - 1] == values[i]);
+
+        if (extends) {
+            (*ranges)[pos - 1].end = glyphs[i];
+        } else {
+            (*ranges)[pos++] = (tt_kern_range){
+                .start = glyphs[i],
+                .end = glyphs[i],
+                .value = values == NULL ? 0 : values[i],
+            };
+        }
+    }
+
+    // Tables should already be sorted, but lookups rely on it
+    qsort(*ranges, num_ranges, sizeof(tt_kern_range), _tt_kern_range_cmp);
+
+    return num_ranges;
+}
+
+// Decodes a coverage table into the covered glyphs and their coverage indices
+// Returns the number of covered glyphs
+u32 _tt_kern_coverage(
+    mem_arena* arena, u8* data, u32 length, u64 offset,
+    u16** glyphs, u16** indices
+) {
+    *glyphs = NULL;
+    *indices = NULL;
+
+    if (!_tt_kern_in_bounds(length, offset, 4)) { return 0; }
+
+    u16 format = _TT_READ_BE16(data + offset);
+    u32 count = _TT_READ_BE16(data + offset + 2);
+
+    if (format == 1) {
+        if (!_tt_kern_in_bounds(length, offset + 4, (u64)count * 2)) { return 0; }
+
+        *glyphs = PUSH_ARRAY_NZ(arena, u16, count);
+        *indices = PUSH_ARRAY_NZ(arena, u16, count);
+
+        be16_decode(*glyphs, data + offset + 4, count);
+
+        for (u32 i = 0; i < count; i++) {
+            (*indices)[i] = (u16)i;
+        }
+
+        return count;
+    }
+
+    if (format != 2 || !_tt_kern_in_bounds(length, offset + 4, (u64)count * 6)) {
+        return 0;
+    }
+
+    u8* ranges = data + offset + 4;
+
+    u32 num_covered = 0;
+    for (u32 i = 0; i < count; i++) {
+        u16 start = _TT_READ_BE16(ranges + i * 6 + 0);
+        u16 end = _TT_READ_BE16(ranges + i * 6 + 2);
+
+        if (start <= end) {
+            num_covered += (u32)(end - start) + 1;
+        }
+    }
+
+    *glyphs = PUSH_ARRAY_NZ(arena, u16, num_covered);
+    *indices = PUSH_ARRAY_NZ(arena, u16, num_covered);
+
+    u32 pos = 0;
+    for (u32 i = 0; i < count; i++) {
+        u16 start = _TT_READ_BE16(ranges + i * 6 + 0);
+        u16 end = _TT_READ_BE16(ranges + i * 6 + 2);
+        u16 start_index = _TT_READ_BE16(ranges + i * 6 + 4);
+
+        for (u32 glyph = start; glyph <= end; glyph++) {
+            (*glyphs)[pos] = (u16)glyph;
+            (*indices)[pos] = (u16)(start_index + (glyph - start));
+            pos++;
+        }
+    }
+
+    return num_covered;
+}
+
+// Decodes a class definition table into sorted ranges of glyphs
+// Glyphs that are not listed are in class 0, so class 0 is left out
+// Returns the number of ranges
+u32 _tt_kern_class_def(
+    mem_arena* arena, mem_arena* scratch, u8* data, u32 length, u64 offset,
+    tt_kern_range** ranges
+) {
+    *ranges = NULL;
+
+    if (!_tt_kern_in_bounds(length, offset, 4)) { return 0; }
+
+    u16 format = _TT_READ_BE16(data + offset);
+
+    if (format == 1) {
+        if (!_tt_kern_in_bounds(length, offset, 6)) { return 0; }
+
+        u32 start = _TT_READ_BE16(data + offset + 2);
+        u32 count = _TT_READ_BE16(data + offset + 4);
+
+        if (!_tt_kern_in_bounds(length, offset + 6, (u64)count * 2)) { return 0; }
+
+        mem_arena_temp temp = arena_temp_begin(scratch);
+
+        u16* glyphs = PUSH_ARRAY_NZ(scratch, u16, count);
+        u16* classes = PUSH_ARRAY_NZ(scratch, u16, count);
+
+        u32 num_listed = 0;
+        for (u32 i = 0; i < count && start + i <= 0xffff; i++) {
+            u16 class_value = _TT_READ_BE16(data + offset + 6 + i * 2);
+            if (class_value == 0) { continue; }
+
+            glyphs[num_listed] = (u16)(start + i);
+            classes[num_listed] = class_value;
+            num_listed++;
+        }
+
+        u32 num_ranges = _tt_kern_pack_ranges(arena, glyphs, classes, num_listed, ranges);
+
+        arena_temp_end(temp);
+
+        return num_ranges;
+    }
+
+    if (format != 2) { return 0; }
+
+    u32 count = _TT_READ_BE16(data + offset + 2);
+
+    if (!_tt_kern_in_bounds(length, offset + 4, (u64)count * 6)) { return 0; }
+
+    *ranges = PUSH_ARRAY_NZ(arena, tt_kern_range, count);
+
+    u32 num_ranges = 0;
+    for (u32 i = 0; i < count; i++) {
+        u8* range = data + offset + 4 + i * 6;
+
+        tt_kern_range decoded = {
+            .start = _TT_READ_BE16(range + 0),
+            .end = _TT_READ_BE16(range + 2),
+            .value = _TT_READ_BE16(range + 4),
+        };
+
+        if (decoded.start <= decoded.end && decoded.value != 0) {
+            (*ranges)[num_ranges++] = decoded;
+        }
+    }
+
+    qsort(*ranges, num_ranges, sizeof(tt_kern_range), _tt_kern_range_cmp);
+
+    return num_ranges;
+}
+
+// Adds the adjustment of the first class subtable of each lookup
+// that covers `left`, starting at `subtable`
+i32 _tt_kern_class_lookup(const tt_kern_class_subtable* subtable, u32 left, u32 right) {
+    i32 value = 0;
+    u32 matched_lookup = ~(u32)0;
+
+    for (; subtable != NULL; subtable = subtable->next) {
+        if (subtable->lookup == matched_lookup) { continue; }
+        if (_tt_kern_range_find(subtable->coverage, subtable->num_coverage, left) == NULL) {
+            continue;
+        }
+
+        u32 class1 = _tt_kern_range_class(subtable->classes1, subtable->num_classes1, left);
+        if (class1 >= subtable->class1_count) { continue; }
+
+        matched_lookup = subtable->lookup;
+
+        u32 class2 = _tt_kern_range_class(subtable->classes2, subtable->num_classes2, right);
+        if (subtable->values != NULL && class2 < subtable->class2_count) {
+            value += subtable->values[class1 * subtable->class2_count + class2];
+        }
+    }
+
+    return value;
+}
+
+u32 _tt_kern_popcount16(u16 x) {
+    u32 count = 0;
+
+    while (x) {
+        x &= (u16)(x - 1);
+        count++;
+    }
+
+    return count;
+}
+
+// Adds the pairs of a format 1 PairPos subtable to `map`, unless the pair is
+// already set or its left glyph is marked in `class_lefts`
+// A format 2 subtable is returned as a class subtable on `table_arena`,
+// and the glyphs it covers are marked in `class_lefts`
+tt_kern_class_subtable* _tt_kern_parse_pair_pos(
+    mem_arena* arena, mem_arena* table_arena, u8* data, u32 length, u64 subtable,
+    u32 num_glyphs, _tt_kern_map* map, b8* class_lefts
+) {
+    if (!_tt_kern_in_bounds(length, subtable, 10)) { return NULL; }
+
+    u8* header = data + subtable;
+
+    u16 format = _TT_READ_BE16(header + 0);
+    u64 coverage = subtable + _TT_READ_BE16(header + 2);
+    u16 value_format1 = _TT_READ_BE16(header + 4);
+    u16 value_format2 = _TT_READ_BE16(header + 6);
+
+    // Only the x advance of the first glyph is used,
+    // which comes after the x and y placements
+    b32 has_x_advance = (value_format1 & 0x0004) != 0;
+    u32 x_advance_offset = _tt_kern_popcount16(value_format1 & 0x0003) * 2;
+
+    u32 value_size = (_tt_kern_popcount16(value_format1) + _tt_kern_popcount16(value_format2)) * 2;
+
+    tt_kern_class_subtable* out = NULL;
+
+    // No temp here, `map` grows on `arena`, which is reset after each lookup
+    u16* covered_glyphs = NULL;
+    u16* coverage_indices = NULL;
+    u32 num_covered = _tt_kern_coverage(
+        arena, data, length, coverage, &covered_glyphs, &coverage_indices
+    );
+
+    if (format == 1) {
+        u32 num_pair_sets = _TT_READ_BE16(header + 8);
+        if (!_tt_kern_in_bounds(length, subtable + 10, (u64)num_pair_sets * 2)) {
+            return NULL;
+        }
+
+        u32 record_size = 2 + value_size;
+
+        for (u32 i = 0; i < num_covered; i++) {
+            u32 left = covered_glyphs[i];
+            u32 pair_set_index = coverage_indices[i];
+
+            if (left >= num_glyphs || pair_set_index >= num_pair_sets) { continue; }
+            if (class_lefts[left]) { continue; }
+
+            u64 pair_set = subtable + _TT_READ_BE16(header + 10 + pair_set_index * 2);
+            if (!_tt_kern_in_bounds(length, pair_set, 2)) { continue; }
+
+            u32 num_pairs = _TT_READ_BE16(data + pair_set);
+            if (!_tt_kern_in_bounds(length, pair_set + 2, (u64)num_pairs * record_size)) {
+                continue;
+            }
+
+            for (u32 j = 0; j < num_pairs; j++) {
+                u8* record = data + pair_set + 2 + j * record_size;
+
+                u32 right = _TT_READ_BE16(record);
+                i32 value = has_x_advance ?
+                    (i16)_TT_READ_BE16(record + 2 + x_advance_offset) : 0;
+
+                // Zeros are kept, they still hide later subtables
+                _tt_kern_map_insert(map, left, right, value);
+            }
+        }
+    } else if (format == 2) {
+        if (!_tt_kern_in_bounds(length, subtable, 16)) { return NULL; }
+
+        u64 class_def1 = subtable + _TT_READ_BE16(header + 8);
+        u64 class_def2 = subtable + _TT_READ_BE16(header + 10);
+        u32 class1_count = _TT_READ_BE16(header + 12);
+        u32 class2_count = _TT_READ_BE16(header + 14);
+
+        if (!_tt_kern_in_bounds(
+            length, subtable + 16, (u64)class1_count * class2_count * value_size
+        )) {
+            return NULL;
+        }
+
+        out = PUSH_STRUCT(table_arena, tt_kern_class_subtable);
+
+        out->class1_count = class1_count;
+        out->class2_count = class2_count;
+
+        out->num_coverage = _tt_kern_pack_ranges(
+            table_arena, covered_glyphs, NULL, num_covered, &out->coverage
+        );
+        out->num_classes1 = _tt_kern_class_def(
+            table_arena, arena, data, length, class_def1, &out->classes1
+        );
+        out->num_classes2 = _tt_kern_class_def(
+            table_arena, arena, data, length, class_def2, &out->classes2
+        );
+
+        if (has_x_advance) {
+            u32 num_values = class1_count * class2_count;
+            out->values = PUSH_ARRAY_NZ(table_arena, i16, num_values);
+
+            for (u32 i = 0; i < num_values; i++) {
+                out->values[i] = (i16)_TT_READ_BE16(header + 16 + i * value_size + x_advance_offset);
+            }
+        }
+
+        for (u32 i = 0; i < num_covered; i++) {
+            u32 left = covered_glyphs[i];
+            if (left >= num_glyphs) { continue; }
+
+            u32 class1 = _tt_kern_range_class(out->classes1, out->num_classes1, left);
+            class_lefts[left] |= (b8)(class1 < class1_count);
+        }
+    }
+
+    return out;
+}
+
+// Returns false if the font has no PairPos lookups for the kern feature
+// Class subtables are allocated on `table_arena` and appended to `first`/`last`
+b32 _tt_kern_parse_gpos(
+    mem_arena* arena, mem_arena* table_arena, string8 file, tt_font_info* info,
+    tt_font_table gpos, _tt_kern_map* map,
+    tt_kern_class_subtable** first, tt_kern_class_subtable** last
+) {
+    u8* data = file.str + gpos.offset;
+    u32 length = gpos.length;
+
+    if (length < 10 || _TT_READ_BE16(data) != 1) { return false; }
+
+    u32 feature_list = _TT_READ_BE16(data + 6);
+    u32 lookup_list = _TT_READ_BE16(data + 8);
+
+    if (
+        !_tt_kern_in_bounds(length, feature_list, 2) ||
+        !_tt_kern_in_bounds(length, lookup_list, 2)
+    ) {
+        return false;
+    }
+
+    u32 num_features = _TT_READ_BE16(data + feature_list);
+    u32 num_lookups = _TT_READ_BE16(data + lookup_list);
+
+    if (
+        !_tt_kern_in_bounds(length, feature_list + 2, (u64)num_features * 6) ||
+        !_tt_kern_in_bounds(length, lookup_list + 2, (u64)num_lookups * 2)
+    ) {
+        return false;
+    }
+
+    mem_arena_temp temp = arena_temp_begin(arena);
+
+    // Lookups of every kern feature, regardless of script and language
+    b8* use_lookup = PUSH_ARRAY(arena, b8, num_lookups);
+
+    for (u32 i = 0; i < num_features; i++) {
+        u8* record = data + feature_list + 2 + i * 6;
+        if (_TT_READ_BE32(record) != _TT_TAG("kern")) { continue; }
+
+        u64 feature = feature_list + _TT_READ_BE16(record + 4);
+        if (!_tt_kern_in_bounds(length, feature, 4)) { continue; }
+
+        u32 num_indices = _TT_READ_BE16(data + feature + 2);
+        if (!_tt_kern_in_bounds(length, feature + 4, (u64)num_indices * 2)) { continue; }
+
+        for (u32 j = 0; j < num_indices; j++) {
+            u32 lookup_index = _TT_READ_BE16(data + feature + 4 + j * 2);
+
+            if (lookup_index < num_lookups) {
+                use_lookup[lookup_index] = true;
+            }
+        }
+    }
+
+    b32 found = false;
+
+    // Lookups are applied in order, and their adjustments add up
+    for (u32 i = 0; i < num_lookups; i++) {
+        if (!use_lookup[i]) { continue; }
+
+        u64 lookup = lookup_list + _TT_READ_BE16(data + lookup_list + 2 + i * 2);
+        if (!_tt_kern_in_bounds(length, lookup, 6)) { continue; }
+
+        u16 lookup_type = _TT_READ_BE16(data + lookup);
+        u32 num_subtables = _TT_READ_BE16(data + lookup + 4);
+
+        // Type 9 is an extension, which can wrap PairPos subtables
+        if (lookup_type != 2 && lookup_type != 9) { continue; }
+        if (!_tt_kern_in_bounds(length, lookup + 6, (u64)num_subtables * 2)) { continue; }
+
+        mem_arena_temp lookup_temp = arena_temp_begin(arena);
+
+        _tt_kern_map lookup_map = { 0 };
+        _tt_kern_map_init(&lookup_map, arena, 8);
+
+        b8* class_lefts = PUSH_ARRAY(arena, b8, info->num_glyphs);
+        tt_kern_class_subtable* prev_last = *last;
+
+        // Within a lookup, the first subtable that covers a pair is used
+        for (u32 j = 0; j < num_subtables; j++) {
+            u64 subtable = lookup + _TT_READ_BE16(data + lookup + 6 + j * 2);
+
+            if (lookup_type == 9) {
+                if (
+                    !_tt_kern_in_bounds(length, subtable, 8) ||
+                    _TT_READ_BE16(data + subtable + 2) != 2
+                ) {
+                    continue;
+                }
+
+                subtable += _TT_READ_BE32(data + subtable + 4);
+            }
+
+            found = true;
+
+            tt_kern_class_subtable* class_subtable = _tt_kern_parse_pair_pos(
+                arena, table_arena, data, length, subtable,
+                info->num_glyphs, &lookup_map, class_lefts
+            );
+
+            if (class_subtable != NULL) {
+                class_subtable->lookup = i;
+                SLL_PUSH_BACK(*first, *last, class_subtable);
+            }
+        }
+
+        // A pair that comes before the class subtables covering its left glyph
+        // replaces their adjustment, which is added back at lookup time
+        tt_kern_class_subtable* lookup_classes = prev_last == NULL ? *first : prev_last->next;
+
+        for (u32 j = 0; j < lookup_map.capacity; j++) {
+            u32 key = lookup_map.keys[j];
+            if (key == TT_KERN_EMPTY_KEY) { continue; }
+
+            u32 left = key >> 16;
+            u32 right = key & 0xffff;
+            i32 value = lookup_map.values[j] - _tt_kern_class_lookup(lookup_classes, left, right);
+
+            _tt_kern_map_set(map, left, right, value, true);
+        }
+
+        arena_temp_end(lookup_temp);
+    }
+
+    arena_temp_end(temp);
+
+    return found;
+}
+
+void _tt_kern_parse_kern(string8 file, tt_font_table kern, _tt_kern_map* map) {
+    u8* data = file.str + kern.offset;
+    u32 length = kern.length;
+
+    // Only the Microsoft version of the table is supported,
+    // Apple's has a 32 bit version number
+    if (length < 4 || _TT_READ_BE16(data) != 0) { return; }
+
+    u32 num_tables = _TT_READ_BE16(data + 2);
+
+    u64 offset = 4;
+    for (u32 i = 0; i < num_tables; i++) {
+        if (!_tt_kern_in_bounds(length, offset, 6)) { break; }
+
+        u64 subtable_length = _TT_READ_BE16(data + offset + 2);
+        u16 coverage = _TT_READ_BE16(data + offset + 4);
+
+        // Format 0, horizontal, not minimum values, not cross stream
+        if ((coverage >> 8) == 0 && _tt_kern_in_bounds(length, offset, 14)) {
+            u32 num_pairs = _TT_READ_BE16(data + offset + 6);
+
+            // Large subtables overflow the 16 bit length,
+            // so the pair count is trusted instead (within the table)
+            num_pairs = (u32)MIN(num_pairs, (length - offset - 14) / 6);
+            subtable_length = MAX(subtable_length, 14 + (u64)num_pairs * 6);
+
+            if ((coverage & 0x0007) == 0x0001) {
+                b32 add = (coverage & 0x0008) == 0;
+
+                for (u32 j = 0; j < num_pairs; j++) {
+                    u8* pair = data + offset + 14 + j * 6;
+
+                    _tt_kern_map_set(
+                        map, _TT_READ_BE16(pair + 0), _TT_READ_BE16(pair + 2),
+                        (i16)_TT_READ_BE16(pair + 4), add
+                    );
+                }
+            }
+        }
+
+        if (subtable_length < 6) { break; }
+
+        offset += subtable_length;
+    }
+}
+
+void tt_font_build_kern_table(mem_arena* arena, string8 file, tt_font_info* info) {
+    if (info == NULL || !info->initialized) { return; }
+
+    u32 num_glyphs = info->num_glyphs;
+
+    mem_arena_temp scratch = arena_scratch_get(&arena, 1);
+    mem_arena_temp lookup_scratch = arena_scratch_get(
+        (mem_arena*[]){ arena, scratch.arena }, 2
+    );
+
+    _tt_kern_map map = { 0 };
+    _tt_kern_map_init(&map, scratch.arena, 8);
+
+    b32 found = false;
+
+    tt_kern_class_subtable* first_class = NULL;
+    tt_kern_class_subtable* last_class = NULL;
+
+    tt_font_table gpos = { 0 };
+    if (_tt_get_validate_table(file, _TT_TAG("GPOS"), &gpos, false, NULL)) {
+        found = _tt_kern_parse_gpos(
+            lookup_scratch.arena, arena, file, info, gpos, &map, &first_class, &last_class
+        );
+    }
+
+    tt_font_table kern = { 0 };
+    if (!found && _tt_get_validate_table(file, _TT_TAG("kern"), &kern, false, NULL)) {
+        _tt_kern_parse_kern(file, kern, &map);
+    }
+
+    u32 num_pairs = 0;
+    for (u32 i = 0; i < map.capacity; i++) {
+        num_pairs += map.keys[i] != TT_KERN_EMPTY_KEY && map.values[i] != 0;
+    }
+
+    u32 capacity_log2 = 4;
+    while (((u32)1 << capacity_log2) < num_pairs * 2) {
+        capacity_log2++;
+    }
+
+    tt_kern_table* table = PUSH_STRUCT(arena, tt_kern_table);
+
+    table->capacity = (u32)1 << capacity_log2;
+    table->num_pairs = num_pairs;
+    table->hash_shift = 32 - capacity_log2;
+    table->class_subtables = first_class;
+
+    table->keys = PUSH_ARRAY_NZ(arena, u32, table->capacity);
+    table->values = PUSH_ARRAY(arena, i16, table->capacity);
+    table->left_bits = PUSH_ARRAY(arena, u8, (num_glyphs + 7) / 8);
+
+    memset(table->keys, 0xff, sizeof(u32) * table->capacity);
+
+    for (u32 i = 0; i < map.capacity; i++) {
+        u32 key = map.keys[i];
+        u32 left = key >> 16;
+        u32 right = key & 0xffff;
+
+        if (
+            key == TT_KERN_EMPTY_KEY || map.values[i] == 0 ||
+            left >= num_glyphs || right >= num_glyphs
+        ) {
+            continue;
+        }
+
+        u32 slot = _tt_kern_hash(key, table->hash_shift);
+        while (table->keys[slot] != TT_KERN_EMPTY_KEY) {
+            slot = (slot + 1) & (table->capacity - 1);
+        }
+
+        table->keys[slot] = key;
+        table->values[slot] = (i16)CLAMP(map.values[i], -32768, 32767);
+
+        table->left_bits[left >> 3] |= (u8)(1 << (left & 7));
+    }
+
+    for (tt_kern_class_subtable* subtable = first_class; subtable != NULL; subtable = subtable->next) {
+        for (u32 i = 0; i < subtable->num_coverage; i++) {
+            u32 end = MIN(subtable->coverage[i].end, num_glyphs - 1);
+
+            for (u32 left = subtable->coverage[i].start; left <= end && left < num_glyphs; left++) {
+                table->left_bits[left >> 3] |= (u8)(1 << (left & 7));
+            }
+        }
+    }
+
+    arena_scratch_release(lookup_scratch);
+    arena_scratch_release(scratch);
+
+    info->kern_table = table;
+}
+
+i32 _tt_kern_lookup(const tt_kern_table* table, u32 left, u32 right) {
+    if ((table->left_bits[left >> 3] & (1 << (left & 7))) == 0) { return 0; }
+
+    i32 value = 0;
+
+    u32 key = left << 16 | right;
+    u32 slot = _tt_kern_hash(key, table->hash_shift);
+
+    while (table->keys[slot] != TT_KERN_EMPTY_KEY) {
+        if (table->keys[slot] == key) {
+            value = table->values[slot];
+            break;
+        }
+
+        slot = (slot + 1) & (table->capacity - 1);
+    }
+
+    if (table->class_subtables != NULL) {
+        value += _tt_kern_class_lookup(table->class_subtables, left, right);
+    }
+
+    return value;
+}
+
+i32 tt_kern(const tt_font_info* info, u32 left, u32 right) {
+    if (info == NULL || info->kern_table == NULL) { return 0; }
+    if (left >= info->num_glyphs || right >= info->num_glyphs) { return 0; }
+
+    return _tt_kern_lookup(info->kern_table, left, right);
+}
+
+void tt_kern_run(
+    const tt_font_info* info, const u32* glyph_indices,
+    u32 count, i32* advances
+) {
+    if (info == NULL || info->kern_table == NULL) { return; }
+
+    const tt_kern_table* table = info->kern_table;
+    u32 num_glyphs = info->num_glyphs;
+
+    for (u32 i = 0; i + 1 < count; i++) {
+        u32 left = glyph_indices[i];
+        u32 right = glyph_indices[i + 1];
+
+        if (left < num_glyphs && right < num_glyphs) {
+            advances[i] += _tt_kern_lookup(table, left, right);
+        }
+    }
+}
+
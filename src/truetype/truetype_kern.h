@@ -0,0 +1,80 @@
+
+#define TT_KERN_EMPTY_KEY (~(u32)0)
+
+// Glyphs `start` to `end` (inclusive), which all have the class `value`
+typedef struct {
+    u16 start;
+    u16 end;
+    u16 value;
+} tt_kern_range;
+
+// GPOS PairPos format 2 subtable, kept as classes instead of pairs
+// The adjustment of a covered left glyph is looked up from the class
+// of each glyph, so every right glyph is covered
+typedef struct tt_kern_class_subtable {
+    struct tt_kern_class_subtable* next;
+
+    // Index of the GPOS lookup, only the first subtable
+    // of a lookup covering the left glyph is used
+    u32 lookup;
+
+    // All ranges are sorted by `start`, glyphs not in `classes1`
+    // or `classes2` are in class 0
+    u32 num_coverage;
+    u32 num_classes1;
+    u32 num_classes2;
+    tt_kern_range* coverage;
+    tt_kern_range* classes1;
+    tt_kern_range* classes2;
+
+    u32 class1_count;
+    u32 class2_count;
+    // Horizontal adjustment of `class1 * class2_count + class2`,
+    // NULL if the subtable has no x advance
+    i16* values;
+} tt_kern_class_subtable;
+
+// Kerning pairs of a font in an open addressing hash table,
+// followed by class subtables for any pair missing from the table
+// See `tt_font_build_kern_table`
+typedef struct tt_kern_table {
+    // Always a power of two, and at least twice `num_pairs`
+    u32 capacity;
+    u32 num_pairs;
+    // Keys are hashed by multiplying and keeping the top bits
+    u32 hash_shift;
+
+    // `left << 16 | right`, or `TT_KERN_EMPTY_KEY` for empty slots
+    u32* keys;
+    // Horizontal adjustment in font units
+    i16* values;
+
+    // In lookup order, added to the value from the hash table
+    // Pairs in the hash table already subtract the class adjustment
+    // they take precedence over
+    tt_kern_class_subtable* class_subtables;
+
+    // One bit per glyph, set if the glyph is on the left of any pair
+    // or covered by a class subtable
+    // Lets most lookups skip the hash table
+    u8* left_bits;
+} tt_kern_table;
+
+// Collects the pairs from GPOS PairPos lookups (formats 1 and 2) used by
+// the `kern` feature, or from format 0 subtables of the kern table
+// if the font has no GPOS kerning
+// Format 2 subtables are kept as class subtables rather than expanded to pairs
+// The table is allocated on `arena` and stored in `info`
+void tt_font_build_kern_table(mem_arena* arena, string8 file, tt_font_info* info);
+
+// Horizontal adjustment between two glyphs, in font units
+// Returns 0 if the kern table has not been built
+i32 tt_kern(const tt_font_info* info, u32 left, u32 right);
+
+// Adds the kerning between each glyph and the next one to `advances`
+// `advances` has `count` elements, and the last one is unchanged
+void tt_kern_run(
+    const tt_font_info* info, const u32* glyph_indices,
+    u32 count, i32* advances
+);
+
@@ -19,14 +19,31 @@ typedef struct {
 
 u32 _tt_calc_checksum(string8 file, u32 offset, u32 len);
 // Does not bounds check table records
-b32 _tt_get_validate_table(string8 file, u32 table_tag, tt_font_table* table);
+// Only verifies the table checksum if `checksum` is true
+// `expected_checksum` can be NULL
+b32 _tt_get_validate_table(
+    string8 file, u32 table_tag, tt_font_table* table,
+    b32 checksum, u32* expected_checksum
+);
+// Checksums the table the first time it is called for it
+b32 _tt_table_usable(string8 file, tt_font_table table, tt_table_check* check);
 // Assumes loca is already validated
 b32 _tt_validate_loca(string8 file, const tt_font_info* info);
 // Assumes cmap is already validated
 b32 _tt_find_cmap_subtable(string8 file, tt_font_info* info, tt_font_table cmap);
 _tt_glyf_entry _tt_find_glyf_entry(string8 file, tt_font_info* info, u32 glyph_index);
-
-void tt_font_init(string8 file, tt_font_info* info) {
+// Looks up the codepoint in the cmap subtable itself
+u32 _tt_glyph_index_cmap(string8 file, tt_font_info* info, u32 codepoint);
+// Returns NULL if the glyph is not in the font's component cache
+tt_glyph_data* _tt_cached_component(tt_font_info* info, u32 glyph_index);
+// Number of codepoint ranges (segments/groups) in the cmap subtable
+u32 _tt_cmap_num_ranges(string8 file, tt_font_info* info);
+// Inclusive range of codepoints that may be mapped
+void _tt_cmap_get_range(
+    string8 file, tt_font_info* info, u32 range, u32* first, u32* last
+);
+
+void tt_font_init(string8 file, tt_font_info* info, tt_validation_level validation) {
     if (file.size <= 12) {
         error_emit("Cannit parse TTF (invalid file)");
         goto invalid; 
@@ -38,10 +55,12 @@ void tt_font_init(string8 file, tt_font_info* info) {
         goto invalid;
     }
 
-    u32 file_checksum = _tt_calc_checksum(file, 0, (u32)file.size);
-    if (file_checksum != 0xB1B0AFBA) {
-        error_emit("Invalid/corrupted TTF file (checksum failed)");
-        goto invalid;
+    if (validation == TT_VALIDATION_FULL) {
+        u32 file_checksum = _tt_calc_checksum(file, 0, (u32)file.size);
+        if (file_checksum != 0xB1B0AFBA) {
+            error_emit("Invalid/corrupted TTF file (checksum failed)");
+            goto invalid;
+        }
     }
 
     u16 num_tables = _TT_READ_BE16(file.str + 4);
@@ -52,27 +71,55 @@ void tt_font_init(string8 file, tt_font_info* info) {
 
     tt_font_table cmap = { 0 };
     tt_font_table maxp = { 0 };
+    tt_font_table hhea = { 0 };
+
+    // The small tables are used immediately, so they are checked here
+    // The large tables are only checksummed with full validation
+    b32 check_small = validation != TT_VALIDATION_NONE;
+    b32 check_large = validation == TT_VALIDATION_FULL;
 
     if (
-        !_tt_get_validate_table(file, _TT_TAG("head"), &info->head) ||
-        !_tt_get_validate_table(file, _TT_TAG("glyf"), &info->glyf) ||
-        !_tt_get_validate_table(file, _TT_TAG("hmtx"), &info->hmtx) ||
-        !_tt_get_validate_table(file, _TT_TAG("loca"), &info->loca) ||
-        !_tt_get_validate_table(file, _TT_TAG("cmap"), &cmap) ||
-        !_tt_get_validate_table(file, _TT_TAG("maxp"), &maxp) ||
-        info->head.length != 54 || maxp.length < 6
+        !_tt_get_validate_table(file, _TT_TAG("head"), &info->head, check_small, NULL) ||
+        !_tt_get_validate_table(
+            file, _TT_TAG("glyf"), &info->glyf, check_large, &info->glyf_check.expected_checksum
+        ) ||
+        !_tt_get_validate_table(
+            file, _TT_TAG("hmtx"), &info->hmtx, check_large, &info->hmtx_check.expected_checksum
+        ) ||
+        !_tt_get_validate_table(
+            file, _TT_TAG("loca"), &info->loca, check_large, &info->loca_check.expected_checksum
+        ) ||
+        !_tt_get_validate_table(file, _TT_TAG("cmap"), &cmap, check_small, NULL) ||
+        !_tt_get_validate_table(file, _TT_TAG("maxp"), &maxp, check_small, NULL) ||
+        !_tt_get_validate_table(file, _TT_TAG("hhea"), &hhea, check_small, NULL) ||
+        info->head.length != 54 || maxp.length < 6 || hhea.length != 36
     ) {
         error_emit("Cannot parse TTF (invalid tables)");
         goto invalid;
     }
 
+    // Lazily validated tables are checksummed by `_tt_table_usable`
+    u32 large_state = validation == TT_VALIDATION_LAZY ?
+        TT_TABLE_UNCHECKED : TT_TABLE_VALID;
+
+    info->glyf_check.state = large_state;
+    info->hmtx_check.state = large_state;
+    info->loca_check.state = large_state;
+
+    info->units_per_em = _TT_READ_BE16(file.str + info->head.offset + 18);
+    if (info->units_per_em == 0) {
+        error_emit("Cannot parse TTF (invalid units per em)");
+        goto invalid;
+    }
+
     info->loca_format = (i16)_TT_READ_BE16(file.str + info->head.offset + 50);
     if (info->loca_format != 0 && info->loca_format != 1) {
         error_emit("Cannot parse TTF (invalid loca format)");
         goto invalid;
     }
 
-    if (!_tt_validate_loca(file, info)) {
+    // Otherwise, loca offsets are checked as each glyph is loaded
+    if (check_large && !_tt_validate_loca(file, info)) {
         error_emit("Cannot parse TTF (invalid loca offsets)");
         goto invalid;
     }
@@ -106,6 +153,21 @@ void tt_font_init(string8 file, tt_font_info* info) {
             info->max_glyph_contours;
     }
 
+    // hhea parsing
+    {
+        info->num_hmetrics = _TT_READ_BE16(file.str + hhea.offset + 34);
+
+        // Each full record is an advance and an lsb,
+        // and the remaining glyphs only have an lsb
+        u32 min_hmtx_length = (u32)info->num_hmetrics * 4 +
+            (u32)(info->num_glyphs - MIN(info->num_glyphs, info->num_hmetrics)) * 2;
+
+        if (info->num_hmetrics == 0 || info->hmtx.length < min_hmtx_length) {
+            error_emit("Cannot parse TTF (invalid hmtx)");
+            goto invalid;
+        }
+    }
+
     if (!_tt_find_cmap_subtable(file, info, cmap)) {
         error_emit("Cannot parse TTF (unable to find supported cmap)");
         goto invalid;
@@ -122,27 +184,184 @@ invalid:
 f32 tt_scale_for_em(string8 file, tt_font_info* info, f32 pixels_per_em) {
     if (info == NULL || !info->initialized) { return 1.0f; }
 
-    f32 units_per_em = (f32)_TT_READ_BE16(file.str + info->head.offset + 18);
-    return pixels_per_em / units_per_em;
+    UNUSED(file);
+
+    return pixels_per_em / (f32)info->units_per_em;
 }
 
-// Used for loading in glyphs before the number of total points is known
+#define _TT_MAX_COMPONENT_DEPTH 16
+
 typedef struct {
     u32 num_contours;
     u32 num_segments;
     u32 num_points;
+} _tt_glyph_counts;
+
+typedef struct {
+    u16 flags;
+    u16 glyph_index;
+
+    i16 raw_x_offset;
+    i16 raw_y_offset;
+    i32 parent_point;
+    i32 child_point;
+
+    b8 scale_offset;
+
+    // Row major
+    f32 mat[4];
+} _tt_glyph_component;
+
+// Validates the header of a simple glyph description
+// and finds where its flags start
+b32 _tt_simple_glyph_header(
+    u8* glyf_data, u32 length, u32 num_contours,
+    u32* num_raw_points, u32* flags_offset
+) {
+    if (length < 12 + num_contours * 2) {
+        return false;
+    }
+
+    u16 instruction_length = _TT_READ_BE16(glyf_data + 10 + num_contours * 2);
+    if (length < 12 + num_contours * 2 + instruction_length) {
+        return false;
+    }
+
+    // Contour end points have to be increasing
+    // for the contours to be well defined
+    u32 prev_end = 0;
+    for (u32 c = 0; c < num_contours; c++) {
+        u32 end_point = _TT_READ_BE16(glyf_data + 10 + c * 2);
+
+        if (c > 0 && end_point <= prev_end) {
+            return false;
+        }
+
+        prev_end = end_point;
+    }
+
+    *num_raw_points = prev_end + 1;
+    *flags_offset = 12 + num_contours * 2 + instruction_length;
+
+    return true;
+}
+
+// Parses the component record at `*data_offset` and advances past it
+b32 _tt_parse_glyph_component(
+    u8* glyf_data, u32 length, u32* data_offset, _tt_glyph_component* comp
+) {
+    u32 offset = *data_offset;
+
+    if (offset + 4 > length) { return false; }
+
+    *comp = (_tt_glyph_component){
+        .flags = _TT_READ_BE16(glyf_data + offset + 0),
+        .glyph_index = _TT_READ_BE16(glyf_data + offset + 2),
+        .parent_point = -1,
+        .child_point = -1,
+        .mat = {
+            1.0f, 0.0f,
+            0.0f, 1.0f
+        }
+    };
+    offset += 4;
 
-    u32 max_points;
+    u16 flags = comp->flags;
 
-    tt_point_flag* flags;
-    v2_i16* points;
-} _tt_temp_glyph;
+    if (flags & 0x0002) {
+        // ARGS_ARE_XY_VALUES
+        if (flags & 0x0001 && offset + 4 <= length) {
+            // 16 bit offsets
+            comp->raw_x_offset = (i16)_TT_READ_BE16(glyf_data + offset + 0);
+            comp->raw_y_offset = (i16)_TT_READ_BE16(glyf_data + offset + 2);
 
-// Recursively adds points to the `_tt_temp_glyph` structure
-b32 _tt_glyph_add_points(
+            offset += 4;
+        } else if (offset + 2 <= length) {
+            // 8 bit offsets
+            comp->raw_x_offset = (i8)(*(glyf_data + offset + 0));
+            comp->raw_y_offset = (i8)(*(glyf_data + offset + 1));
+
+            offset += 2;
+        }
+
+        if (flags & 0x0800) {
+            // SCALED_COMPONENT_OFFSET
+            comp->scale_offset = true;
+        }
+
+        // This is defined as the default behavior,
+        // hence the if instead of else if
+        if (flags & 0x1000) {
+            // UNSCALED_COMPONENT_OFFSET
+            comp->scale_offset = false;
+        }
+    } else {
+        // Not ARGS_ARE_XY_VALUES
+        // (args are point numbers)
+        if (flags & 0x0001 && offset + 4 <= length) {
+            // 16 bit point indices
+            comp->parent_point = _TT_READ_BE16(glyf_data + offset + 0);
+            comp->child_point = _TT_READ_BE16(glyf_data + offset + 2);
+
+            offset += 4;
+        } else if (offset + 2 <= length) {
+            // 8 bit point indices
+            comp->parent_point = *(glyf_data + offset + 0);
+            comp->child_point = *(glyf_data + offset + 1);
+
+            offset += 2;
+        }
+    }
+
+    f32* mat = comp->mat;
+
+    if ((flags & 0x0008) && offset + 2 <= length) {
+        // WE_HAVE_A_SCALE
+        i16 scale_2_14 = (i16)_TT_READ_BE16(glyf_data + offset);
+        offset += 2;
+
+        f32 scale = (f32)scale_2_14 / (f32)(1 << 14);
+        mat[0] = scale;
+        mat[3] = scale;
+    } else if ((flags & 0x0040) && offset + 4 <= length) {
+        // WE_HAVE_AN_X_AND_Y_SCALE
+        i16 xscale_2_14 = (i16)_TT_READ_BE16(glyf_data + offset + 0);
+        i16 yscale_2_14 = (i16)_TT_READ_BE16(glyf_data + offset + 2);
+        offset += 4;
+
+        mat[0] = (f32)xscale_2_14 / (f32)(1 << 14);
+        mat[3] = (f32)yscale_2_14 / (f32)(1 << 14);
+    } else if ((flags & 0x0080) && offset + 8 <= length) {
+        // WE_HAVE_A_TWO_BY_TWO
+        i16 m00_2_14 = (i16)_TT_READ_BE16(glyf_data + offset + 0);
+        i16 m10_2_14 = (i16)_TT_READ_BE16(glyf_data + offset + 2);
+        i16 m01_2_14 = (i16)_TT_READ_BE16(glyf_data + offset + 4);
+        i16 m11_2_14 = (i16)_TT_READ_BE16(glyf_data + offset + 6);
+        offset += 8;
+
+        mat[0] = (f32)m00_2_14 / (f32)(1 << 14);
+        mat[1] = (f32)m01_2_14 / (f32)(1 << 14);
+        mat[2] = (f32)m10_2_14 / (f32)(1 << 14);
+        mat[3] = (f32)m11_2_14 / (f32)(1 << 14);
+    }
+
+    *data_offset = offset;
+
+    return true;
+}
+
+// Computes the exact number of points, segments, and contours the glyph
+// will have after processing. Only the flags are read, not the coordinates
+//
+// Within a contour, every off curve point is the control point of
+// exactly one bezier, and every on curve point followed by another
+// on curve point starts a line. Each contour also has a closing point
+b32 _tt_glyph_count(
     string8 file, tt_font_info* info,
-    _tt_temp_glyph* glyph, u32 glyph_index
+    _tt_glyph_counts* counts, u32 glyph_index, u32 depth
 ) {
+    if (depth > _TT_MAX_COMPONENT_DEPTH) { return false; }
+
     _tt_glyf_entry entry = _tt_find_glyf_entry(file, info, glyph_index);
     if (entry.length < 10) { return false; }
 
@@ -152,25 +371,162 @@ b32 _tt_glyph_add_points(
 
     if (num_contours > 0) {
         // Simple glyph description
-        if (entry.length < 12 + (u32)num_contours * 2) {
-            return false; 
-        }
+        u32 num_raw_points = 0;
+        u32 data_offset = 0;
 
-        u16 instruction_length = _TT_READ_BE16(glyf_data + 10 + num_contours * 2);
-        if (entry.length < 12 + (u32)num_contours * 2 + instruction_length) {
+        if (!_tt_simple_glyph_header(
+            glyf_data, entry.length, (u32)num_contours,
+            &num_raw_points, &data_offset
+        )) {
             return false;
         }
 
-        glyph->num_contours += (u32)num_contours;
+        u32 contour = 0;
+        u32 contour_start = 0;
+        u32 contour_end = _TT_READ_BE16(glyf_data + 10);
+
+        u32 num_lines = 0;
+        u32 num_off_curve = 0;
+
+        b32 first_on = false, prev_on = false;
+
+        // Flags are walked in runs of repeated flags
+        u32 i = 0;
+        while (i < num_raw_points) {
+            // Same as the flag decoding in `_tt_glyph_decode`,
+            // missing flags are treated as zero
+            u8 flag = 0;
+            u32 run_length = num_raw_points - i;
+
+            if (data_offset < entry.length) {
+                flag = *(glyf_data + data_offset);
+                data_offset++;
+
+                run_length = 1;
+
+                // Checking REPEAT flag
+                if ((flag & 0x08) && data_offset < entry.length) {
+                    run_length += *(glyf_data + data_offset);
+                    data_offset++;
+                }
+
+                run_length = MIN(run_length, num_raw_points - i);
+            }
+
+            b32 on = flag & 0x1;
+
+            while (run_length > 0) {
+                u32 n = MIN(run_length, contour_end + 1 - i);
+
+                if (i == contour_start) {
+                    first_on = on;
+                } else if (prev_on && on) {
+                    num_lines++;
+                }
+
+                if (on) {
+                    num_lines += n - 1;
+                } else {
+                    num_off_curve += n;
+                }
 
-        u32 num_raw_points = (u32)_TT_READ_BE16(glyf_data + 10 + (num_contours - 1) * 2) + 1;
+                i += n;
+                run_length -= n;
+                prev_on = on;
 
-        mem_arena_temp scratch = arena_scratch_get(NULL, 0);
+                if (i == contour_end + 1) {
+                    // Wrapping around to the start of the contour
+                    if (prev_on && first_on) {
+                        num_lines++;
+                    }
 
-        u8* flags_raw = PUSH_ARRAY(scratch.arena, u8, num_raw_points);
-        v2_i16* points_raw = PUSH_ARRAY(scratch.arena, v2_i16, num_raw_points);
+                    contour++;
+                    contour_start = i;
+
+                    if (contour < (u32)num_contours) {
+                        contour_end = _TT_READ_BE16(glyf_data + 10 + contour * 2);
+                    }
+                }
+            }
+        }
+
+        u32 num_segments = num_lines + num_off_curve;
+        // Cast once, gcc flags `(u32)` of an i16 inside the sums below
+        u32 num_contours_u32 = (u32)num_contours;
+
+        counts->num_contours += num_contours_u32;
+        counts->num_segments += num_segments;
+        counts->num_points += num_segments + num_off_curve + num_contours_u32;
+    } else if (num_contours < 0) {
+        // Compound glyph description
+        u32 data_offset = 10;
+        b8 more = true;
+        while (more && data_offset < entry.length) {
+            _tt_glyph_component comp = { 0 };
+
+            if (!_tt_parse_glyph_component(
+                glyf_data, entry.length, &data_offset, &comp
+            )) {
+                return false;
+            }
+
+            tt_glyph_data* cached = _tt_cached_component(info, comp.glyph_index);
+
+            if (cached != NULL) {
+                counts->num_contours += cached->num_contours;
+                counts->num_segments += cached->num_segments;
+                counts->num_points += cached->num_points;
+            } else if (!_tt_glyph_count(file, info, counts, comp.glyph_index, depth + 1)) {
+                return false;
+            }
+
+            more = (comp.flags & 0x0020) == 0x0020;
+        }
+    }
+
+    return true;
+}
+
+// Decodes the glyph into `glyph`, starting at `glyph->num_points`
+// The arrays end at `region_end`, which is exactly the number of points from `_tt_glyph_count`
+//
+// The raw points are first decoded into the end of the region,
+// then expanded towards the start of the region. Every raw point produces
+// at least one output point, so the output never overtakes raw points
+// that have not been read yet
+b32 _tt_glyph_decode(
+    string8 file, tt_font_info* info,
+    tt_glyph_data* glyph, u32 glyph_index, u32 region_end, u32 depth
+) {
+    if (depth > _TT_MAX_COMPONENT_DEPTH) { return false; }
+
+    _tt_glyf_entry entry = _tt_find_glyf_entry(file, info, glyph_index);
+    if (entry.length < 10) { return false; }
+
+    u8* glyf_data = file.str + info->glyf.offset + entry.offset;
+
+    i16 num_contours = (i16)_TT_READ_BE16(glyf_data);
+
+    if (num_contours > 0) {
+        // Simple glyph description
+        u32 num_raw_points = 0;
+        u32 data_offset = 0;
+
+        if (!_tt_simple_glyph_header(
+            glyf_data, entry.length, (u32)num_contours,
+            &num_raw_points, &data_offset
+        )) {
+            return false;
+        }
+
+        if (num_raw_points > region_end - glyph->num_points) { return false; }
+
+        u32 raw_start = region_end - num_raw_points;
+        u8* flags_raw = glyph->flags + raw_start;
+        v2_i16* points_raw = glyph->points + raw_start;
+
+        memset(flags_raw, 0, num_raw_points);
 
-        u32 data_offset = 12 + (u32)num_contours * 2 + instruction_length;
         u32 num_flags = 0;
 
         while (num_flags < num_raw_points && data_offset < entry.length) {
@@ -230,21 +586,52 @@ b32 _tt_glyph_add_points(
             points_raw[i].y = y;
         }
 
+        // Kept in locals, since the compiler cannot
+        // tell that the flag writes do not alias `glyph`
+        tt_point_flag* out_flags = glyph->flags;
+        v2_i16* out_points = glyph->points;
+        u32 out_index = glyph->num_points;
+
         for (i32 c = 0; c < num_contours; c++) {
             u32 start_point = c <= 0 ? 0 : (_TT_READ_BE16(glyf_data + 10 + (c-1) * 2) + 1);
             u32 end_point = _TT_READ_BE16(glyf_data + 10 + c * 2);
 
             u32 num_points = end_point - start_point + 1;
+
+            // When the contour wraps around, the first few raw points
+            // may have already been overwritten by output points
+            u8 wrap_flags[3] = { 0 };
+            v2_i16 wrap_points[3] = { 0 };
+            for (u32 i = 0; i < 3; i++) {
+                wrap_flags[i] = flags_raw[start_point + i % num_points];
+                wrap_points[i] = points_raw[start_point + i % num_points];
+            }
+
             i32 point_offset = 0;
             b8 just_offset = false;
             for (i32 i = 0; i < (i32)num_points; i++) {
-                u32 p0_i = (((u32)(i + point_offset + 0) % num_points) + start_point);
-                u32 p1_i = (((u32)(i + point_offset + 1) % num_points) + start_point);
-                u32 p2_i = (((u32)(i + point_offset + 2) % num_points) + start_point);
+                u32 cur_i[3] = {
+                    (u32)(i + point_offset + 0),
+                    (u32)(i + point_offset + 1),
+                    (u32)(i + point_offset + 2),
+                };
+
+                u8 cur_flags[3];
+                v2_i16 cur_points[3];
+
+                for (u32 j = 0; j < 3; j++) {
+                    if (cur_i[j] < num_points) {
+                        cur_flags[j] = flags_raw[start_point + cur_i[j]];
+                        cur_points[j] = points_raw[start_point + cur_i[j]];
+                    } else {
+                        cur_flags[j] = wrap_flags[cur_i[j] - num_points];
+                        cur_points[j] = wrap_points[cur_i[j] - num_points];
+                    }
+                }
 
-                v2_i16 p0 = points_raw[p0_i];
-                v2_i16 p1 = points_raw[p1_i];
-                v2_i16 p2 = points_raw[p2_i];
+                v2_i16 p0 = cur_points[0];
+                v2_i16 p1 = cur_points[1];
+                v2_i16 p2 = cur_points[2];
 
                 tt_point_flag p0_flag = just_offset ? TT_POINT_FLAG_CONTOUR_OFFSET : 0;
                 tt_point_flag p1_flag = 0;
@@ -255,9 +642,9 @@ b32 _tt_glyph_add_points(
                 b8 bez = true, skip = false;
 
                 u32 on_curve_bits = (u32)(
-                    (flags_raw[p0_i] & 0x1) << 2 |
-                    (flags_raw[p1_i] & 0x1) << 1 |
-                    (flags_raw[p2_i] & 0x1) << 0
+                    (cur_flags[0] & 0x1) << 2 |
+                    (cur_flags[1] & 0x1) << 1 |
+                    (cur_flags[2] & 0x1) << 0
                 );
 
                 switch (on_curve_bits) {
@@ -330,141 +717,78 @@ b32 _tt_glyph_add_points(
 
                 if (skip) { continue; }
 
-                glyph->num_segments++;
-
-                glyph->num_points++;
-                glyph->flags[glyph->num_points-1] = p0_flag;
-                glyph->points[glyph->num_points-1] = p0;
+                out_flags[out_index] = p0_flag;
+                out_points[out_index] = p0;
+                out_index++;
 
                 if (bez) {
-                    glyph->num_points++;
-                    glyph->flags[glyph->num_points-1] = p1_flag;
-                    glyph->points[glyph->num_points-1] = p1;
+                    out_flags[out_index] = p1_flag;
+                    out_points[out_index] = p1;
+                    out_index++;
                 }
 
                 if (i == (i32)num_points - 1) {
                     p2_flag |= TT_POINT_FLAG_CONTOUR_END;
 
-                    glyph->num_points++;
-                    glyph->flags[glyph->num_points-1] = p2_flag;
-                    glyph->points[glyph->num_points-1] = p2;
+                    out_flags[out_index] = p2_flag;
+                    out_points[out_index] = p2;
+                    out_index++;
                 }
             }
         }
 
-        arena_scratch_release(scratch);
+        glyph->num_points = out_index;
     } else if (num_contours < 0) {
         // Compound glyph description
 
         u32 data_offset = 10;
         b8 more = true;
         while (more && data_offset < entry.length) {
-            if (data_offset + 4 > entry.length) { return false; }
+            _tt_glyph_component comp = { 0 };
 
-            u16 flags = _TT_READ_BE16(glyf_data + data_offset + 0);
-            u16 child_glyph_index = _TT_READ_BE16(glyf_data + data_offset + 2);
-            data_offset += 4;
-
-            i16 raw_x_offset = 0, raw_y_offset = 0;
-            i32 parent_point = -1, child_point = -1;
-
-            b8 scale_offset = false;
-
-            if (flags & 0x0002) {
-                // ARGS_ARE_XY_VALUES
-                if (flags & 0x0001 && data_offset + 4 <= entry.length) {
-                    // 16 bit offsets
-                    raw_x_offset = (i16)_TT_READ_BE16(glyf_data + data_offset + 0);
-                    raw_y_offset = (i16)_TT_READ_BE16(glyf_data + data_offset + 2);
+            if (!_tt_parse_glyph_component(
+                glyf_data, entry.length, &data_offset, &comp
+            )) {
+                return false;
+            }
 
-                    data_offset += 4;
-                } else if (data_offset + 2 <= entry.length) {
-                    // 8 bit offsets
-                    raw_x_offset = (i8)(*(glyf_data + data_offset + 0));
-                    raw_y_offset = (i8)(*(glyf_data + data_offset + 1));
+            tt_glyph_data* cached = _tt_cached_component(info, comp.glyph_index);
 
-                    data_offset += 2;
-                }
-
-                if (flags & 0x0800) {
-                    // SCALED_COMPONENT_OFFSET
-                    scale_offset = true;
-                }
+            u32 child_start_index = glyph->num_points;
 
-                // This is defined as the default behavior,
-                // hence the if instead of else if
-                if (flags & 0x1000) {
-                    // UNSCALED_COMPONENT_OFFSET
-                    scale_offset = false;
-                }
-            } else {
-                // Not ARGS_ARE_XY_VALUES
-                // (args are point numbers)
-                if (flags & 0x0001 && data_offset + 4 <= entry.length) {
-                    // 16 bit point indices
-                    parent_point = _TT_READ_BE16(glyf_data + data_offset + 0);
-                    child_point = _TT_READ_BE16(glyf_data + data_offset + 2);
-
-                    data_offset += 4;
-                } else if (data_offset + 2 <= entry.length) {
-                    // 8 bit point indices
-                    parent_point = *(glyf_data + data_offset + 0);
-                    child_point = *(glyf_data + data_offset + 1);
-
-                    data_offset += 2;
+            if (cached != NULL) {
+                if (cached->num_points > region_end - glyph->num_points) {
+                    return false;
                 }
-            }
-
-            // Row major
-            f32 mat[4] = {
-                1.0f, 0.0f,
-                0.0f, 1.0f
-            };
-
-            if ((flags & 0x0008) && data_offset + 2 <= entry.length) {
-                // WE_HAVE_A_SCALE
-                i16 scale_2_14 = (i16)_TT_READ_BE16(glyf_data + data_offset);
-                data_offset += 2;
 
-                f32 scale = (f32)scale_2_14 / (f32)(1 << 14);
-                mat[0] = scale;
-                mat[3] = scale;
-            } else if ((flags & 0x0040) && data_offset + 4 <= entry.length) {
-                // WE_HAVE_AN_X_AND_Y_SCALE
-                i16 xscale_2_14 = (i16)_TT_READ_BE16(glyf_data + data_offset + 0);
-                i16 yscale_2_14 = (i16)_TT_READ_BE16(glyf_data + data_offset + 2);
-                data_offset += 4;
-
-                mat[0] = (f32)xscale_2_14 / (f32)(1 << 14);
-                mat[3] = (f32)yscale_2_14 / (f32)(1 << 14);
-            } else if ((flags & 0x0080) && data_offset + 8 <= entry.length) {
-                // WE_HAVE_A_TWO_BY_TWO
-                i16 m00_2_14 = (i16)_TT_READ_BE16(glyf_data + data_offset + 0);
-                i16 m10_2_14 = (i16)_TT_READ_BE16(glyf_data + data_offset + 2);
-                i16 m01_2_14 = (i16)_TT_READ_BE16(glyf_data + data_offset + 4);
-                i16 m11_2_14 = (i16)_TT_READ_BE16(glyf_data + data_offset + 6);
-                data_offset += 8;
-
-                mat[0] = (f32)m00_2_14 / (f32)(1 << 14);
-                mat[1] = (f32)m01_2_14 / (f32)(1 << 14);
-                mat[2] = (f32)m10_2_14 / (f32)(1 << 14);
-                mat[3] = (f32)m11_2_14 / (f32)(1 << 14);
-            }
+                memcpy(
+                    glyph->flags + glyph->num_points, cached->flags,
+                    sizeof(tt_point_flag) * cached->num_points
+                );
+                memcpy(
+                    glyph->points + glyph->num_points, cached->points,
+                    sizeof(v2_i16) * cached->num_points
+                );
 
-            u32 child_start_index = glyph->num_points;
-            if (!_tt_glyph_add_points(file, info, glyph, child_glyph_index)) {
+                glyph->num_points += cached->num_points;
+            } else if (!_tt_glyph_decode(
+                // Each component is decoded into the rest of the region
+                file, info, glyph, comp.glyph_index, region_end, depth + 1
+            )) {
                 return false;
             }
 
-            if (parent_point >= 0 && child_point >= 0) {
+            if (comp.parent_point >= 0 && comp.child_point >= 0) {
                 warn_emit("TTF compound point aligning unsupported");
             }
 
-            f32 x_offset = (f32)raw_x_offset;
-            f32 y_offset = (f32)raw_y_offset;
-            if (scale_offset) {
-                x_offset = mat[0] * (f32)raw_x_offset + mat[1] * (f32)raw_y_offset;
-                y_offset = mat[2] * (f32)raw_x_offset + mat[3] * (f32)raw_y_offset;
+            f32* mat = comp.mat;
+
+            f32 x_offset = (f32)comp.raw_x_offset;
+            f32 y_offset = (f32)comp.raw_y_offset;
+            if (comp.scale_offset) {
+                x_offset = mat[0] * (f32)comp.raw_x_offset + mat[1] * (f32)comp.raw_y_offset;
+                y_offset = mat[2] * (f32)comp.raw_x_offset + mat[3] * (f32)comp.raw_y_offset;
             }
 
             for (u32 i = child_start_index; i < glyph->num_points; i++) {
@@ -475,7 +799,7 @@ b32 _tt_glyph_add_points(
                 glyph->points[i].y = (i16)(mat[2] * x + mat[3] * y + y_offset);
             }
 
-            more = (flags & 0x0020) == 0x0020;
+            more = (comp.flags & 0x0020) == 0x0020;
         }
     }
 
@@ -500,35 +824,31 @@ tt_glyph_data tt_glyph_data_from_index(
         .y_max = (i16)_TT_READ_BE16(file.str + offset + 8),
     };
 
-    mem_arena_temp scratch = arena_scratch_get(&arena, 1);
-
-    // Here, I add in all the implied bezier points and duplicate the contour
-    // start/end point. As such, this should be a sufficient upper bound
-    u32 max_points = info->max_glyph_points * 2 + info->max_glyph_contours;
-    _tt_temp_glyph temp_glyph = {
-        .max_points = max_points,
-        .flags = PUSH_ARRAY(scratch.arena, tt_point_flag, max_points),
-        .points = PUSH_ARRAY(scratch.arena, v2_i16, max_points),
-    };
-
-    if (!_tt_glyph_add_points(file, info, &temp_glyph, glyph_index)) {
+    // Counting first, so the glyph can be decoded
+    // directly into exactly sized arrays
+    _tt_glyph_counts counts = { 0 };
+    if (!_tt_glyph_count(file, info, &counts, glyph_index, 0)) {
         error_emit("Failed to parse TTF glyph");
-        arena_scratch_release(scratch);
-
         goto fail;
     }
 
-    glyph.num_contours = temp_glyph.num_contours;
-    glyph.num_segments = temp_glyph.num_segments;
-    glyph.num_points = temp_glyph.num_points;
+    mem_arena_temp maybe_temp = arena_temp_begin(arena);
 
-    glyph.flags = PUSH_ARRAY_NZ(arena, tt_point_flag, glyph.num_points);
-    glyph.points = PUSH_ARRAY_NZ(arena, v2_i16, glyph.num_points);
+    glyph.flags = PUSH_ARRAY_NZ(arena, tt_point_flag, counts.num_points);
+    glyph.points = PUSH_ARRAY_NZ(arena, v2_i16, counts.num_points);
 
-    memcpy(glyph.flags, temp_glyph.flags, sizeof(tt_point_flag) * glyph.num_points);
-    memcpy(glyph.points, temp_glyph.points, sizeof(v2_i16) * glyph.num_points);
+    if (
+        !_tt_glyph_decode(file, info, &glyph, glyph_index, counts.num_points, 0) ||
+        glyph.num_points != counts.num_points
+    ) {
+        error_emit("Failed to parse TTF glyph");
+        arena_temp_end(maybe_temp);
 
-    arena_scratch_release(scratch);
+        goto fail;
+    }
+
+    glyph.num_contours = counts.num_contours;
+    glyph.num_segments = counts.num_segments;
 
     return glyph;
 
@@ -547,6 +867,355 @@ tt_glyph_data tt_glyph_data_from_codepoint(
 u32 tt_glyph_index(string8 file, tt_font_info* info, u32 codepoint) {
     if (info == NULL || !info->initialized) { return 0; }
 
+    tt_cmap_table* table = info->cmap_table;
+
+    if (table != NULL) {
+        if (codepoint >= TT_CMAP_TABLE_NUM_BLOCKS * TT_CMAP_TABLE_BLOCK_SIZE) {
+            return 0;
+        }
+
+        u32 page = table->page_indices[codepoint / TT_CMAP_TABLE_BLOCK_SIZE];
+        return table->pages[
+            page * TT_CMAP_TABLE_BLOCK_SIZE + codepoint % TT_CMAP_TABLE_BLOCK_SIZE
+        ];
+    }
+
+    return _tt_glyph_index_cmap(file, info, codepoint);
+}
+
+u32 tt_glyph_indices(string8 file, tt_font_info* info, string8 text, u32* out) {
+    if (info == NULL || !info->initialized) { return 0; }
+
+    // All ASCII codepoints are in the first block
+    const u16* ascii_page = NULL;
+    if (info->cmap_table != NULL) {
+        ascii_page = info->cmap_table->pages +
+            info->cmap_table->page_indices[0] * TT_CMAP_TABLE_BLOCK_SIZE;
+    }
+
+    u32 num_indices = 0;
+    u64 offset = 0;
+
+    while (offset < text.size) {
+        if (ascii_page != NULL) {
+            // Eight ASCII characters at a time
+            while (offset + 8 <= text.size) {
+                u64 chars = 0;
+                memcpy(&chars, text.str + offset, sizeof(u64));
+
+                if (chars & 0x8080808080808080ULL) { break; }
+
+                for (u32 i = 0; i < 8; i++) {
+                    out[num_indices++] = ascii_page[text.str[offset + i]];
+                }
+
+                offset += 8;
+            }
+
+            while (offset < text.size && text.str[offset] < 0x80) {
+                out[num_indices++] = ascii_page[text.str[offset++]];
+            }
+
+            if (offset >= text.size) { break; }
+        }
+
+        string_decode decode = utf8_decode(text, offset);
+        offset += decode.len;
+
+        out[num_indices++] = tt_glyph_index(file, info, decode.codepoint);
+    }
+
+    return num_indices;
+}
+
+void tt_font_build_cmap_table(mem_arena* arena, string8 file, tt_font_info* info) {
+    if (info == NULL || !info->initialized) { return; }
+
+    tt_cmap_table* table = PUSH_STRUCT(arena, tt_cmap_table);
+    table->page_indices = PUSH_ARRAY(arena, u16, TT_CMAP_TABLE_NUM_BLOCKS);
+
+    u32 max_codepoint = TT_CMAP_TABLE_NUM_BLOCKS * TT_CMAP_TABLE_BLOCK_SIZE - 1;
+    u32 num_ranges = _tt_cmap_num_ranges(file, info);
+
+    // Page 0 is reserved for unmapped blocks
+    table->num_pages = 1;
+
+    for (u32 i = 0; i < num_ranges; i++) {
+        u32 first = 0, last = 0;
+        _tt_cmap_get_range(file, info, i, &first, &last);
+
+        if (first > max_codepoint) { continue; }
+        last = MIN(last, max_codepoint);
+
+        for (
+            u32 block = first / TT_CMAP_TABLE_BLOCK_SIZE;
+            block <= last / TT_CMAP_TABLE_BLOCK_SIZE; block++
+        ) {
+            if (table->page_indices[block] == 0) {
+                table->page_indices[block] = (u16)table->num_pages++;
+            }
+        }
+    }
+
+    table->pages = PUSH_ARRAY(
+        arena, u16, (u64)table->num_pages * TT_CMAP_TABLE_BLOCK_SIZE
+    );
+
+    for (u32 i = 0; i < num_ranges; i++) {
+        u32 first = 0, last = 0;
+        _tt_cmap_get_range(file, info, i, &first, &last);
+
+        if (first > max_codepoint) { continue; }
+        last = MIN(last, max_codepoint);
+
+        for (u32 codepoint = first; codepoint <= last; codepoint++) {
+            u32 page = table->page_indices[codepoint / TT_CMAP_TABLE_BLOCK_SIZE];
+
+            table->pages[
+                page * TT_CMAP_TABLE_BLOCK_SIZE + codepoint % TT_CMAP_TABLE_BLOCK_SIZE
+            ] = (u16)_tt_glyph_index_cmap(file, info, codepoint);
+        }
+    }
+
+    info->cmap_table = table;
+}
+
+tt_hmetrics tt_glyph_hmetrics(string8 file, tt_font_info* info, u32 glyph_index) {
+    if (info == NULL || !info->initialized || glyph_index >= info->num_glyphs) {
+        return (tt_hmetrics){ 0 };
+    }
+
+    tt_hmetrics_table* table = info->hmetrics_table;
+
+    if (table != NULL) {
+        return (tt_hmetrics){
+            .advance = table->advances[glyph_index],
+            .lsb = table->lsbs[glyph_index],
+        };
+    }
+
+    if (!_tt_table_usable(file, info->hmtx, &info->hmtx_check)) {
+        return (tt_hmetrics){ 0 };
+    }
+
+    u8* hmtx = file.str + info->hmtx.offset;
+    u32 num_hmetrics = info->num_hmetrics;
+
+    if (glyph_index < num_hmetrics) {
+        return (tt_hmetrics){
+            .advance = _TT_READ_BE16(hmtx + glyph_index * 4),
+            .lsb = (i16)_TT_READ_BE16(hmtx + glyph_index * 4 + 2),
+        };
+    }
+
+    // Glyphs past the full records use the last advance
+    return (tt_hmetrics){
+        .advance = _TT_READ_BE16(hmtx + (num_hmetrics - 1) * 4),
+        .lsb = (i16)_TT_READ_BE16(hmtx + num_hmetrics * 4 + (glyph_index - num_hmetrics) * 2),
+    };
+}
+
+u64 tt_glyphs_advance(
+    string8 file, tt_font_info* info,
+    const u32* glyph_indices, u32 count
+) {
+    if (info == NULL || !info->initialized) { return 0; }
+
+    u64 advance = 0;
+
+    tt_hmetrics_table* table = info->hmetrics_table;
+
+    if (table != NULL) {
+        for (u32 i = 0; i < count; i++) {
+            u32 index = glyph_indices[i];
+            advance += index < info->num_glyphs ? table->advances[index] : 0;
+        }
+    } else {
+        for (u32 i = 0; i < count; i++) {
+            advance += tt_glyph_hmetrics(file, info, glyph_indices[i]).advance;
+        }
+    }
+
+    return advance;
+}
+
+void tt_font_build_hmetrics_table(mem_arena* arena, string8 file, tt_font_info* info) {
+    if (
+        info == NULL || !info->initialized ||
+        !_tt_table_usable(file, info->hmtx, &info->hmtx_check)
+    ) {
+        return;
+    }
+
+    u32 num_glyphs = info->num_glyphs;
+    u32 num_hmetrics = MIN(info->num_hmetrics, num_glyphs);
+    u8* hmtx = file.str + info->hmtx.offset;
+
+    tt_hmetrics_table* table = PUSH_STRUCT(arena, tt_hmetrics_table);
+    table->advances = PUSH_ARRAY_NZ(arena, u16, num_glyphs);
+    table->lsbs = PUSH_ARRAY_NZ(arena, i16, num_glyphs);
+
+    mem_arena_temp scratch = arena_scratch_get(&arena, 1);
+
+    // Full records are interleaved advances and lsbs
+    u16* records = PUSH_ARRAY_NZ(scratch.arena, u16, num_hmetrics * 2);
+    be16_decode(records, hmtx, num_hmetrics * 2);
+
+    for (u32 i = 0; i < num_hmetrics; i++) {
+        table->advances[i] = records[i * 2 + 0];
+        table->lsbs[i] = (i16)records[i * 2 + 1];
+    }
+
+    arena_scratch_release(scratch);
+
+    u16 last_advance = num_hmetrics ? table->advances[num_hmetrics - 1] : 0;
+    for (u32 i = num_hmetrics; i < num_glyphs; i++) {
+        table->advances[i] = last_advance;
+    }
+
+    be16_decode(
+        (u16*)(table->lsbs + num_hmetrics), hmtx + num_hmetrics * 4,
+        num_glyphs - num_hmetrics
+    );
+
+    info->hmetrics_table = table;
+}
+
+void tt_font_build_component_cache(mem_arena* arena, string8 file, tt_font_info* info) {
+    if (info == NULL || !info->initialized) { return; }
+
+    mem_arena_temp scratch = arena_scratch_get(&arena, 1);
+
+    tt_component_cache* cache = PUSH_STRUCT(arena, tt_component_cache);
+    cache->component_slots = PUSH_ARRAY(arena, u32, info->num_glyphs);
+
+    // Counting how many times each glyph is used as a component
+    u32* ref_counts = PUSH_ARRAY(scratch.arena, u32, info->num_glyphs);
+
+    for (u32 i = 0; i < info->num_glyphs; i++) {
+        _tt_glyf_entry entry = _tt_find_glyf_entry(file, info, i);
+        if (entry.length < 10) { continue; }
+
+        u8* glyf_data = file.str + info->glyf.offset + entry.offset;
+
+        if ((i16)_TT_READ_BE16(glyf_data) >= 0) { continue; }
+
+        u32 data_offset = 10;
+        b8 more = true;
+        while (more && data_offset < entry.length) {
+            _tt_glyph_component comp = { 0 };
+
+            if (!_tt_parse_glyph_component(
+                glyf_data, entry.length, &data_offset, &comp
+            )) {
+                break;
+            }
+
+            if (comp.glyph_index < info->num_glyphs) {
+                ref_counts[comp.glyph_index]++;
+                cache->num_references++;
+            }
+
+            more = (comp.flags & 0x0020) == 0x0020;
+        }
+    }
+
+    u32 max_components = 0;
+    for (u32 i = 0; i < info->num_glyphs; i++) {
+        max_components += ref_counts[i] > 0;
+    }
+
+    cache->components = PUSH_ARRAY(arena, tt_glyph_data, max_components);
+
+    // `info->component_cache` is still NULL, so nested
+    // components are decoded without the cache
+    for (u32 i = 0; i < info->num_glyphs; i++) {
+        if (ref_counts[i] == 0) { continue; }
+
+        tt_glyph_data glyph = tt_glyph_data_from_index(arena, file, info, i);
+
+        // Glyphs that fail to parse are left to fail
+        // in the compound glyphs that use them
+        if (glyph.num_points == 0) { continue; }
+
+        cache->components[cache->num_components++] = glyph;
+        cache->component_slots[i] = cache->num_components;
+
+        cache->num_points += glyph.num_points;
+        cache->num_referenced_points += (u64)glyph.num_points * ref_counts[i];
+    }
+
+    arena_scratch_release(scratch);
+
+    info->component_cache = cache;
+}
+
+tt_glyph_data* _tt_cached_component(tt_font_info* info, u32 glyph_index) {
+    tt_component_cache* cache = info->component_cache;
+
+    if (cache == NULL || glyph_index >= info->num_glyphs) { return NULL; }
+
+    u32 slot = cache->component_slots[glyph_index];
+
+    return slot == 0 ? NULL : &cache->components[slot - 1];
+}
+
+u32 _tt_cmap_num_ranges(string8 file, tt_font_info* info) {
+    u8* subtable = file.str + info->cmap_offset;
+
+    switch (info->cmap_format) {
+        case 0:
+        case 6: return 1;
+        case 4: return _TT_READ_BE16(subtable + 6) / 2;
+        case 12:
+        case 13: return _TT_READ_BE32(subtable + 12);
+        default: return 0;
+    }
+}
+
+void _tt_cmap_get_range(
+    string8 file, tt_font_info* info, u32 range, u32* first, u32* last
+) {
+    u8* subtable = file.str + info->cmap_offset;
+
+    *first = 0;
+    *last = 0;
+
+    switch (info->cmap_format) {
+        case 0: {
+            *last = 0xff;
+        } break;
+
+        case 4: {
+            u16 seg_count = _TT_READ_BE16(subtable + 6) / 2;
+
+            *last = _TT_READ_BE16(subtable + 14 + range * 2);
+            *first = _TT_READ_BE16(subtable + 16 + 2 * seg_count + range * 2);
+        } break;
+
+        case 6: {
+            u16 first_code = _TT_READ_BE16(subtable + 6);
+            u16 entry_count = _TT_READ_BE16(subtable + 8);
+
+            if (entry_count == 0) { return; }
+
+            *first = first_code;
+            *last = (u32)first_code + entry_count - 1;
+        } break;
+
+        case 12:
+        case 13: {
+            u32 group_offset = 16 + 12 * range;
+
+            *first = _TT_READ_BE32(subtable + group_offset);
+            *last = _TT_READ_BE32(subtable + group_offset + 4);
+        } break;
+
+        default: break;
+    }
+}
+
+u32 _tt_glyph_index_cmap(string8 file, tt_font_info* info, u32 codepoint) {
     u8* subtable = file.str + info->cmap_offset;
 
     u32 out = 0;
@@ -709,11 +1378,7 @@ u32 tt_glyph_index(string8 file, tt_font_info* info, u32 codepoint) {
 }
 
 u32 _tt_calc_checksum(string8 file, u32 offset, u32 len) {
-    u32 sum = 0;
-
-    for (u32 i = 0; i < len / 4; i++) {
-        sum += _TT_READ_BE32(file.str + offset + i * 4);
-    }
+    u32 sum = be32_sum(file.str + offset, len / 4);
 
     u32 left_over = 0;
     for (u32 i = 0; i < len % 4; i++) {
@@ -725,68 +1390,98 @@ u32 _tt_calc_checksum(string8 file, u32 offset, u32 len) {
     return sum;
 }
 
-b32 _tt_get_validate_table(string8 file, u32 table_tag, tt_font_table* table) {
+b32 _tt_get_validate_table(
+    string8 file, u32 table_tag, tt_font_table* table,
+    b32 checksum, u32* expected_checksum
+) {
     u16 num_tables = _TT_READ_BE16(file.str + 4);
 
     for (u32 i = 0; i < num_tables; i++) {
         u32 record_offset = 12 + 16 * i;
         u32 tag      = _TT_READ_BE32(file.str + record_offset +  0);
-        u32 checksum = _TT_READ_BE32(file.str + record_offset +  4);
+        u32 expected = _TT_READ_BE32(file.str + record_offset +  4);
         u32 offset   = _TT_READ_BE32(file.str + record_offset +  8);
         u32 length   = _TT_READ_BE32(file.str + record_offset + 12);
 
         if (tag != table_tag) { continue; }
-        if (offset + length >= file.size) { return false; }
+        if ((u64)offset + length > file.size) { return false; }
 
-        u32 real_checksum = _tt_calc_checksum(file, offset, length);
+        if (checksum) {
+            u32 real_checksum = _tt_calc_checksum(file, offset, length);
 
-        // Subtracting head checksumAdjust
-        if (tag == _TT_TAG("head")) {
-            real_checksum -= _TT_READ_BE32(file.str + offset + 8);
-        }
+            // Subtracting head checksumAdjust
+            if (tag == _TT_TAG("head") && length >= 12) {
+                real_checksum -= _TT_READ_BE32(file.str + offset + 8);
+            }
 
-        if (checksum != real_checksum) { return false; }
+            if (expected != real_checksum) { return false; }
+        }
 
         table->offset = offset;
         table->length = length;
 
+        if (expected_checksum != NULL) {
+            *expected_checksum = expected;
+        }
+
         return true;
     }
 
     return false;
 }
 
+b32 _tt_table_usable(string8 file, tt_font_table table, tt_table_check* check) {
+    u32 state = ATOMIC_LOAD_U32(&check->state);
+
+    if (state == TT_TABLE_UNCHECKED) {
+        // Threads racing here compute the same result,
+        // and only the first one to store it reports it
+        b32 valid = _tt_calc_checksum(file, table.offset, table.length) ==
+            check->expected_checksum;
+        state = valid ? TT_TABLE_VALID : TT_TABLE_INVALID;
+
+        if (ATOMIC_CAS_U32(&check->state, TT_TABLE_UNCHECKED, state) && !valid) {
+            error_emit("Invalid/corrupted TTF table (checksum failed)");
+        }
+    }
+
+    return state == TT_TABLE_VALID;
+}
+
 b32 _tt_validate_loca(string8 file, const tt_font_info* info) {
     tt_font_table loca = info->loca;
 
-    if (info->loca_format == 0) {
-        // 16-bit offsets
-        u32 num_offsets = loca.length / sizeof(u16);
-
-        u32 prev_offset = 0;
-        for (u32 i = 0; i < num_offsets; i++) {
-            u32 offset = 2 * (u32)_TT_READ_BE16(file.str + loca.offset + i * 2);
+    // Offsets are decoded in chunks so the
+    // byte swapping can be done in bulk
+    u32 offsets[256];
+    u16 offsets16[256];
 
-            if (offset > info->glyf.length || offset < prev_offset) {
-                return false; 
-            }
+    u32 entry_size = info->loca_format == 0 ? sizeof(u16) : sizeof(u32);
+    u32 num_offsets = loca.length / entry_size;
 
-            prev_offset = offset;
-        }
-    } else {
-        // 32-bit offsets
-        u32 num_offsets = loca.length / sizeof(u32);
+    u32 prev_offset = 0;
+    for (u32 chunk = 0; chunk < num_offsets; chunk += 256) {
+        u32 chunk_size = MIN(256, num_offsets - chunk);
+        u8* chunk_data = file.str + loca.offset + chunk * entry_size;
 
-        u32 prev_offset = 0;
-        for (u32 i = 0; i < num_offsets; i++) {
-            u32 offset = _TT_READ_BE32(file.str + loca.offset + i * 4);
+        if (info->loca_format == 0) {
+            // 16-bit offsets (stored divided by two)
+            be16_decode(offsets16, chunk_data, chunk_size);
 
-            if (offset > info->glyf.length || offset < prev_offset) {
-                return false; 
+            for (u32 i = 0; i < chunk_size; i++) {
+                offsets[i] = 2 * (u32)offsets16[i];
             }
+        } else {
+            // 32-bit offsets
+            be32_decode(offsets, chunk_data, chunk_size);
+        }
 
-            prev_offset = offset;
+        for (u32 i = 0; i < chunk_size; i++) {
+            if (offsets[i] > info->glyf.length || offsets[i] < prev_offset) {
+                return false;
+            }
 
+            prev_offset = offsets[i];
         }
     }
 
@@ -879,7 +1574,7 @@ b32 _tt_find_cmap_subtable(string8 file, tt_font_info* info, tt_font_table cmap)
 
             u16 length = _TT_READ_BE16(file.str + cmap_offset + 2);
             u16 seg_count = _TT_READ_BE16(file.str + cmap_offset + 6) / 2;
-            u32 min_length = 20 + (u32)seg_count * 4 * sizeof(u16);
+            u32 min_length = 16 + (u32)seg_count * 4 * (u32)sizeof(u16);
 
             if (length < min_length || cmap.length < length) {
                 return false;
@@ -952,7 +1647,11 @@ b32 _tt_find_cmap_subtable(string8 file, tt_font_info* info, tt_font_table cmap)
 }
 
 _tt_glyf_entry _tt_find_glyf_entry(string8 file, tt_font_info* info, u32 glyph_index) {
-    if (glyph_index >= info->num_glyphs) {
+    if (
+        glyph_index >= info->num_glyphs ||
+        !_tt_table_usable(file, info->loca, &info->loca_check) ||
+        !_tt_table_usable(file, info->glyf, &info->glyf_check)
+    ) {
         return (_tt_glyf_entry) { 0 };
     }
 
@@ -969,7 +1668,8 @@ _tt_glyf_entry _tt_find_glyf_entry(string8 file, tt_font_info* info, u32 glyph_i
         next_offset = _TT_READ_BE32(loca + (glyph_index + 1) * 4);
     }
 
-    if (next_offset > info->glyf.length) {
+    // This is the only loca check when the font was not fully validated
+    if (next_offset > info->glyf.length || offset > next_offset) {
         return (_tt_glyf_entry) { 0 };
     }
 
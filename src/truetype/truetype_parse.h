@@ -4,6 +4,84 @@ typedef struct {
     u32 length;
 } tt_font_table;
 
+typedef enum {
+    TT_TABLE_UNCHECKED,
+    TT_TABLE_VALID,
+    TT_TABLE_INVALID,
+} tt_table_state;
+
+// Checksum of a table that is checked on first use
+typedef struct {
+    u32 expected_checksum;
+    // `tt_table_state`, only accessed atomically
+    // since glyphs can be loaded from several threads
+    u32 state;
+} tt_table_check;
+
+typedef enum {
+    // Checksums the whole file and every table,
+    // and checks all loca offsets before any glyph is loaded
+    TT_VALIDATION_FULL,
+    // Only checksums the small tables needed at init (head, maxp, cmap)
+    // glyf, loca, and hmtx are checksummed the first time they are used,
+    // and treated as empty if that fails
+    // loca offsets are checked per glyph as glyphs are loaded
+    TT_VALIDATION_LAZY,
+    // Skips all checksums, for trusted fonts
+    // Table bounds and loca offsets are still checked
+    TT_VALIDATION_NONE,
+} tt_validation_level;
+
+// Codepoints are grouped into blocks of 256
+#define TT_CMAP_TABLE_BLOCK_SIZE 256
+#define TT_CMAP_TABLE_NUM_BLOCKS (0x110000 / TT_CMAP_TABLE_BLOCK_SIZE)
+
+// Direct-mapped table from codepoints to glyph indices
+// See `tt_font_build_cmap_table`
+typedef struct {
+    // Page index of each codepoint block
+    // Page 0 is all zeros, and is shared by every unmapped block
+    u16* page_indices;
+
+    // `num_pages * TT_CMAP_TABLE_BLOCK_SIZE` glyph indices
+    u16* pages;
+    u32 num_pages;
+} tt_cmap_table;
+
+// Horizontal metrics of a glyph, in font units
+typedef struct {
+    u16 advance;
+    // Left side bearing
+    i16 lsb;
+} tt_hmetrics;
+
+// Dense horizontal metrics of every glyph
+// See `tt_font_build_hmetrics_table`
+typedef struct {
+    u16* advances;
+    i16* lsbs;
+} tt_hmetrics_table;
+
+// Decoded outlines of the glyphs used as components by compound glyphs
+// See `tt_font_build_component_cache`
+typedef struct {
+    // For each glyph, its index in `components` plus one,
+    // or 0 if the glyph is not cached
+    u32* component_slots;
+
+    // Untransformed outlines, only the flags, points, and counts are set
+    tt_glyph_data* components;
+    u32 num_components;
+
+    // Number of component records across all compound glyphs
+    u32 num_references;
+
+    // Points stored in the cache, versus the points that would be decoded
+    // by resolving every component record separately
+    u64 num_points;
+    u64 num_referenced_points;
+} tt_component_cache;
+
 typedef struct {
     b8 initialized;
 
@@ -12,6 +90,11 @@ typedef struct {
     i16 loca_format;
     u16 num_glyphs;
     u16 cmap_format;
+    // From head, never 0
+    u16 units_per_em;
+    // Number of full records in hmtx, from hhea
+    // Glyphs after these share the last advance
+    u16 num_hmetrics;
     // Offset of selected cmap subtable, not cmap table itself
     // Offset is from beginning of file
     u32 cmap_offset;
@@ -20,9 +103,20 @@ typedef struct {
     u32 max_glyph_contours;
 
     tt_font_table head, glyf, hmtx, loca;
+    // Already valid unless the font was opened with `TT_VALIDATION_LAZY`
+    tt_table_check glyf_check, hmtx_check, loca_check;
+
+    // Optional, NULL until `tt_font_build_cmap_table` is called
+    tt_cmap_table* cmap_table;
+    // Optional, NULL until `tt_font_build_hmetrics_table` is called
+    tt_hmetrics_table* hmetrics_table;
+    // Optional, NULL until `tt_font_build_kern_table` is called
+    struct tt_kern_table* kern_table;
+    // Optional, NULL until `tt_font_build_component_cache` is called
+    tt_component_cache* component_cache;
 } tt_font_info;
 
-void tt_font_init(string8 file, tt_font_info* info);
+void tt_font_init(string8 file, tt_font_info* info, tt_validation_level validation);
 
 f32 tt_scale_for_em(string8 file, tt_font_info* info, f32 pixels_per_em);
 
@@ -38,3 +132,34 @@ tt_glyph_data tt_glyph_data_from_codepoint(
 
 u32 tt_glyph_index(string8 file, tt_font_info* info, u32 codepoint);
 
+// Decodes the utf-8 `text` and writes the glyph index of each codepoint
+// `out` must have room for at least `text.size` indices
+// Returns the number of indices written
+u32 tt_glyph_indices(string8 file, tt_font_info* info, string8 text, u32* out);
+
+// Builds a direct-mapped lookup table of every codepoint in the cmap,
+// so `tt_glyph_index` becomes two array loads
+// The table is allocated on `arena` and stored in `info`
+void tt_font_build_cmap_table(mem_arena* arena, string8 file, tt_font_info* info);
+
+// Reads from the hmetrics table if it has been built,
+// otherwise from the hmtx table in the file
+// Returns zeroed metrics for invalid glyph indices
+tt_hmetrics tt_glyph_hmetrics(string8 file, tt_font_info* info, u32 glyph_index);
+
+// Sum of the advances of `count` glyphs, in font units
+u64 tt_glyphs_advance(
+    string8 file, tt_font_info* info,
+    const u32* glyph_indices, u32 count
+);
+
+// Decodes the advance and left side bearing of every glyph into dense arrays,
+// so measuring text never has to read the file
+// The table is allocated on `arena` and stored in `info`
+void tt_font_build_hmetrics_table(mem_arena* arena, string8 file, tt_font_info* info);
+
+// Decodes every glyph that is used as a component of a compound glyph once,
+// so compound glyphs only have to copy and transform their components
+// The cache is allocated on `arena` and stored in `info`
+void tt_font_build_component_cache(mem_arena* arena, string8 file, tt_font_info* info);
+
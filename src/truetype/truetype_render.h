@@ -1,8 +1,125 @@
 
 void tt_glyph_color_edges(tt_glyph_data* glyph);
 
+// Segment of an outline with everything that does not depend on the
+// point being measured, shared by the CPU renderers and the shaders
+// Only has 4 byte members, so arrays of it can be read with std430
+typedef struct {
+    // Lines: p0 + t * c1
+    // Quadratics: p0 + 2 * t * c1 + t^2 * c2, with c1 = p1 - p0
+    // and c2 = p2 - 2 * p1 + p0
+    f32 p0_x, p0_y;
+    f32 c1_x, c1_y;
+    f32 c2_x, c2_y;
+
+    // Tight bounding box of the segment
+    f32 min_x, min_y;
+    f32 max_x, max_y;
+
+    // Lines: a = dot(c1, c1)
+    // Quadratics: the closest point to p is at a root of
+    // a t^3 + b t^2 + (c_base - dot(c2, c0)) t - dot(c1, c0), with c0 = p - p0
+    f32 a, b, c_base;
+
+    // 1 / a, or 0 if the segment is a single point
+    f32 inv_a;
+    // Quadratics: the cubic divided by `a` becomes u^3 + p u + q with
+    // t = u - shift, where p = p_base - dot(c2, c0) / a
+    // and q = q_base + (shift * dot(c2, c0) - dot(c1, c0)) / a
+    f32 shift, p_base, q_base;
+
+    // `TT_POINT_FLAG_LINE` and the edge colors from `tt_glyph_color_edges`
+    u32 flags;
+} tt_segment;
+
+// Writes the glyph's segments to `out`, which must have room for
+// `glyph->num_segments`, with points transformed by `p * scale + offset`
+// Quadratics with their control point on the line between
+// their end points are turned into lines
+// Returns the number of segments
+u32 tt_glyph_segments(
+    const tt_glyph_data* glyph, v2_f32 scale, v2_f32 offset, tt_segment* out
+);
+
+// Unsigned distance from `p` to the segment
+f32 tt_segment_dist(const tt_segment* seg, v2_f32 p);
+
+// Distances are signed, with 128 on the outline and higher values inside
+// Inside is decided with the nonzero rule, so overlapping contours
+// (e.g. from composite glyphs) are handled
+// Rows are split into tiles that are submitted to `job_system`
+// (or rendered on the calling thread if it is NULL)
 void tt_render_glyph_sdf(
+    plat_job_system* job_system, bitmap_r8* bmp, v2_i32 offset,
+    tt_glyph_data* glyph, f32 scale, u32 padding, f32 dist_px_range
+);
+
+// Approximates the SDF from a supersampled coverage mask with a
+// Euclidean distance transform, so the cost does not depend on the number
+// of segments. Compared to `tt_render_glyph_sdf` at 16 to 128 px, distances
+// are off by about 0.02 px on average and by up to 0.75 px, mostly near
+// sharp corners and where contours overlap (where the exact SDF also
+// measures the distance to the overlapped edges inside the glyph)
+// Same output format as `tt_render_glyph_sdf`, and the same arguments
+// apart from the job system, as the whole glyph is rendered at once
+void tt_render_glyph_sdf_fast(
     bitmap_r8* bmp, v2_i32 offset, tt_glyph_data* glyph,
     f32 scale, u32 padding, f32 dist_px_range
 );
 
+typedef enum {
+    // `tt_render_glyph_sdf`
+    TT_SDF_MODE_EXACT = 0,
+    // `tt_render_glyph_sdf_fast`
+    TT_SDF_MODE_FAST,
+} tt_sdf_mode;
+
+typedef enum {
+    TT_SDF_FLAG_NONE = 0,
+    // Exact mode only, tests every segment for every pixel instead of
+    // the segments near each pixel. The output is the same, so this is
+    // only a reference to check and time the faster path against
+    TT_SDF_FLAG_BRUTE_FORCE = (1 << 0),
+} tt_sdf_flag;
+
+// Arguments of one `tt_render_glyph_sdf` call
+typedef struct {
+    bitmap_r8* bmp;
+    v2_i32 offset;
+    tt_glyph_data* glyph;
+
+    f32 scale;
+    u32 padding;
+    f32 dist_px_range;
+
+    tt_sdf_mode mode;
+    // `tt_sdf_flag`s
+    u32 flags;
+} tt_sdf_job;
+
+// Renders every job, splitting the rows of all glyphs into tiles that are
+// submitted to `job_system` (or rendered on the calling thread if it is NULL)
+// The output is the same as calling `tt_render_glyph_sdf` for each job
+// Jobs can share a bitmap, as long as their areas do not overlap
+void tt_render_glyphs_sdf(
+    plat_job_system* job_system, const tt_sdf_job* jobs, u32 num_jobs
+);
+
+// Multi-channel SDF, where each channel is the distance to the edges
+// of one color from `tt_glyph_color_edges`, which must be called first
+// Distances are signed, with 128 on the outline and higher values inside
+void tt_render_glyph_msdf(
+    bitmap_rgb8* bmp, v2_i32 offset, tt_glyph_data* glyph,
+    f32 scale, u32 padding, f32 dist_px_range
+);
+
+// Anti-aliased coverage of the glyph, with exact area coverage for each pixel
+// The top left of the bitmap is at `floor(x_min * scale), floor(-y_max * scale)`
+// relative to the glyph's origin (with +y down), so the outline keeps
+// its subpixel position, and the bitmap covers
+// `ceil(x_max * scale) - floor(x_min * scale)` by
+// `ceil(-y_min * scale) - floor(-y_max * scale)` pixels
+void tt_render_glyph_coverage(
+    bitmap_r8* bmp, v2_i32 offset, tt_glyph_data* glyph, f32 scale
+);
+
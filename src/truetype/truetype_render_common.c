@@ -85,3 +85,204 @@ void tt_glyph_color_edges(tt_glyph_data* glyph) {
     }
 }
 
+// Quadratics whose c2 is this small relative to c1 are turned into lines,
+// since the cubic for their closest point is badly conditioned
+#define _TT_SEGMENT_LINE_EPSILON 1e-4f
+
+void _tt_segment_init(
+    tt_segment* out, v2_f32 p0, v2_f32 p1, v2_f32 p2, tt_point_flag flags
+) {
+    v2_f32 c1 = v2_f32_sub(p1, p0);
+    v2_f32 c2 = v2_f32_add(p2, v2_f32_add(v2_f32_scale(p1, -2.0f), p0));
+
+    b32 is_line = (flags & TT_POINT_FLAG_LINE) != 0;
+
+    if (
+        !is_line && v2_f32_dot(c2, c2) <=
+        _TT_SEGMENT_LINE_EPSILON * _TT_SEGMENT_LINE_EPSILON * v2_f32_dot(c1, c1)
+    ) {
+        is_line = true;
+        c1 = v2_f32_sub(p2, p0);
+    }
+
+    if (is_line) {
+        c2 = (v2_f32){ 0.0f, 0.0f };
+        p2 = v2_f32_add(p0, c1);
+    }
+
+    *out = (tt_segment){
+        .p0_x = p0.x, .p0_y = p0.y,
+        .c1_x = c1.x, .c1_y = c1.y,
+        .c2_x = c2.x, .c2_y = c2.y,
+        .min_x = MIN(p0.x, p2.x), .min_y = MIN(p0.y, p2.y),
+        .max_x = MAX(p0.x, p2.x), .max_y = MAX(p0.y, p2.y),
+        .flags = (flags & ~(u32)TT_POINT_FLAG_LINE) | (is_line ? TT_POINT_FLAG_LINE : 0),
+    };
+
+    if (is_line) {
+        out->a = v2_f32_dot(c1, c1);
+        out->inv_a = out->a > 0.0f ? 1.0f / out->a : 0.0f;
+
+        return;
+    }
+
+    // Extremes of each axis are where the derivative 2 * (c1 + t * c2) is 0
+    if (c2.x != 0.0f) {
+        f32 t = -c1.x / c2.x;
+
+        if (t > 0.0f && t < 1.0f) {
+            f32 x = p0.x + t * (2.0f * c1.x + t * c2.x);
+            out->min_x = MIN(out->min_x, x);
+            out->max_x = MAX(out->max_x, x);
+        }
+    }
+    if (c2.y != 0.0f) {
+        f32 t = -c1.y / c2.y;
+
+        if (t > 0.0f && t < 1.0f) {
+            f32 y = p0.y + t * (2.0f * c1.y + t * c2.y);
+            out->min_y = MIN(out->min_y, y);
+            out->max_y = MAX(out->max_y, y);
+        }
+    }
+
+    out->a = v2_f32_dot(c2, c2);
+    out->b = 3.0f * v2_f32_dot(c1, c2);
+    out->c_base = 2.0f * v2_f32_dot(c1, c1);
+    out->inv_a = 1.0f / out->a;
+
+    f32 shift = out->b * out->inv_a * (1.0f / 3.0f);
+    f32 c_norm = out->c_base * out->inv_a;
+
+    out->shift = shift;
+    out->p_base = c_norm - 3.0f * shift * shift;
+    out->q_base = 2.0f * shift * shift * shift - shift * c_norm;
+}
+
+u32 tt_glyph_segments(
+    const tt_glyph_data* glyph, v2_f32 scale, v2_f32 offset, tt_segment* out
+) {
+    u32 index = 0;
+
+    for (u32 seg = 0; seg < glyph->num_segments; seg++) {
+        tt_point_flag flags = glyph->flags[index];
+
+        v2_f32 points[3] = { 0 };
+        u32 num_points = (flags & TT_POINT_FLAG_LINE) ? 2 : 3;
+
+        for (u32 i = 0; i < num_points; i++) {
+            v2_i16 p = glyph->points[index + i];
+            points[i] = (v2_f32){
+                (f32)p.x * scale.x + offset.x,
+                (f32)p.y * scale.y + offset.y,
+            };
+        }
+
+        index += num_points - 1;
+
+        _tt_segment_init(
+            &out[seg], points[0], points[1], points[num_points - 1],
+            flags & (TT_POINT_FLAG_LINE | _TT_WHITE)
+        );
+
+        if (glyph->flags[index] & TT_POINT_FLAG_CONTOUR_END) {
+            index++;
+        }
+    }
+
+    return glyph->num_segments;
+}
+
+v2_f32 _tt_segment_point(const tt_segment* seg, f32 t) {
+    if (seg->flags & TT_POINT_FLAG_LINE) {
+        return (v2_f32){ seg->p0_x + t * seg->c1_x, seg->p0_y + t * seg->c1_y };
+    }
+
+    return (v2_f32){
+        seg->p0_x + t * (2.0f * seg->c1_x + t * seg->c2_x),
+        seg->p0_y + t * (2.0f * seg->c1_y + t * seg->c2_y),
+    };
+}
+
+// Finds the closest point to `p` on the segment
+// Returns the squared distance, and the point's parameter in `out_t`
+f32 _tt_segment_closest(const tt_segment* seg, v2_f32 p, f32* out_t) {
+    f32 c0_x = p.x - seg->p0_x;
+    f32 c0_y = p.y - seg->p0_y;
+
+    f32 ts[2] = { 0.0f, 0.0f };
+    u32 num_t = 1;
+
+    if (seg->flags & TT_POINT_FLAG_LINE) {
+        ts[0] = (c0_x * seg->c1_x + c0_y * seg->c1_y) * seg->inv_a;
+    } else {
+        f32 c2_c0 = seg->c2_x * c0_x + seg->c2_y * c0_y;
+        f32 c1_c0 = seg->c1_x * c0_x + seg->c1_y * c0_y;
+
+        // Depressed cubic u^3 + p u + q
+        f32 dp = seg->p_base - c2_c0 * seg->inv_a;
+        f32 dq = seg->q_base + (seg->shift * c2_c0 - c1_c0) * seg->inv_a;
+
+        f32 h = dq * dq * 0.25f + dp * dp * dp * (1.0f / 27.0f);
+
+        if (h >= 0.0f) {
+            // One real root. The cube root is taken of the larger of
+            // -q/2 +- sqrt(h), and the other term is found from
+            // their product (-p/3) to avoid cancellation
+            f32 w = cbrtf(-0.5f * dq - copysignf(sqrtf(h), dq));
+
+            ts[0] = (w != 0.0f ? w - dp / (3.0f * w) : 0.0f) - seg->shift;
+        } else {
+            // Three real roots, where the middle one is the farthest point
+            // and can be skipped
+            f32 m = sqrtf(-dp * (1.0f / 3.0f));
+            f32 cos_arg = CLAMP(-dq / (2.0f * m * m * m), -1.0f, 1.0f);
+            f32 theta = acosf(cos_arg) * (1.0f / 3.0f);
+
+            f32 cos_theta = cosf(theta);
+            f32 sin_theta = sinf(theta) * 1.7320508f;
+
+            ts[0] = 2.0f * m * cos_theta - seg->shift;
+            ts[1] = -m * (cos_theta + sin_theta) - seg->shift;
+            num_t = 2;
+        }
+
+        // One Newton step on the original cubic cleans up the rounding
+        // error of the shift, which is large for flat curves
+        f32 c = seg->c_base - c2_c0;
+        for (u32 i = 0; i < num_t; i++) {
+            f32 t = ts[i];
+            f32 f = ((seg->a * t + seg->b) * t + c) * t - c1_c0;
+            f32 df = (3.0f * seg->a * t + 2.0f * seg->b) * t + c;
+
+            if (df != 0.0f) {
+                ts[i] = t - f / df;
+            }
+        }
+    }
+
+    // Clamping the two closest roots covers the end points,
+    // as the distance only grows away from them
+    f32 best_dist2 = INFINITY;
+    for (u32 i = 0; i < num_t; i++) {
+        f32 t = CLAMP(ts[i], 0.0f, 1.0f);
+
+        v2_f32 q = _tt_segment_point(seg, t);
+        f32 d_x = p.x - q.x;
+        f32 d_y = p.y - q.y;
+        f32 dist2 = d_x * d_x + d_y * d_y;
+
+        if (dist2 < best_dist2) {
+            best_dist2 = dist2;
+            *out_t = t;
+        }
+    }
+
+    return best_dist2;
+}
+
+f32 tt_segment_dist(const tt_segment* seg, v2_f32 p) {
+    f32 t = 0.0f;
+    return sqrtf(_tt_segment_closest(seg, p, &t));
+}
+
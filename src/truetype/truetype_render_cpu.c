@@ -1,7 +1,1265 @@
 
+// Minimum size of grid cells in pixels
+#define _TT_SDF_MIN_CELL_SIZE 8
+// Max number of cells along each axis of the grid
+#define _TT_SDF_MAX_GRID_CELLS 32
+
+// Uniform grid over the bitmap, where each cell lists every segment
+// that can be within `dist_px_range` of a pixel in the cell
+typedef struct {
+    u32 cell_size;
+    u32 cols, rows;
+
+    // Segments of cell `i` are `cell_segments[cell_starts[i]..cell_starts[i + 1]]`
+    u32* cell_starts;
+    u32* cell_segments;
+} _tt_sdf_grid;
+
+// Gets the glyph's segments in pixel space, where `min_scaled`
+// is the top left of the glyph's scaled bounding box
+// Returns the number of segments
+u32 _tt_sdf_segments(
+    mem_arena* arena, const tt_glyph_data* glyph, f32 scale,
+    v2_f32 min_scaled, u32 padding, tt_segment** out_segments
+) {
+    *out_segments = PUSH_ARRAY_NZ(arena, tt_segment, glyph->num_segments);
+
+    // TTF uses +y up, bitmaps use +y down
+    return tt_glyph_segments(
+        glyph, (v2_f32){ scale, -scale },
+        (v2_f32){ (f32)padding - min_scaled.x, (f32)padding - min_scaled.y },
+        *out_segments
+    );
+}
+
+// Gets the inclusive range of cells that the segment
+// can be within `dist_px_range` of
+// Returns false if the segment is too far from the bitmap
+b32 _tt_sdf_cell_range(
+    const _tt_sdf_grid* grid, const tt_segment* seg,
+    u32 width, u32 height, f32 dist_px_range, u32 range[4]
+) {
+    f32 x_min = seg->min_x - dist_px_range;
+    f32 y_min = seg->min_y - dist_px_range;
+    f32 x_max = seg->max_x + dist_px_range;
+    f32 y_max = seg->max_y + dist_px_range;
+
+    if (x_max < 0.0f || y_max < 0.0f || x_min > (f32)width || y_min > (f32)height) {
+        return false;
+    }
+
+    f32 inv_cell_size = 1.0f / (f32)grid->cell_size;
+
+    range[0] = (u32)CLAMP(floorf(x_min * inv_cell_size), 0.0f, (f32)(grid->cols - 1));
+    range[1] = (u32)CLAMP(floorf(y_min * inv_cell_size), 0.0f, (f32)(grid->rows - 1));
+    range[2] = (u32)CLAMP(floorf(x_max * inv_cell_size), 0.0f, (f32)(grid->cols - 1));
+    range[3] = (u32)CLAMP(floorf(y_max * inv_cell_size), 0.0f, (f32)(grid->rows - 1));
+
+    return true;
+}
+
+void _tt_sdf_grid_build(
+    mem_arena* arena, _tt_sdf_grid* grid,
+    const tt_segment* segments, u32 num_segments,
+    u32 width, u32 height, f32 dist_px_range
+) {
+    u32 max_dim = MAX(width, height);
+
+    grid->cell_size = MAX(
+        _TT_SDF_MIN_CELL_SIZE,
+        (max_dim + _TT_SDF_MAX_GRID_CELLS - 1) / _TT_SDF_MAX_GRID_CELLS
+    );
+    grid->cols = MAX(1, (width + grid->cell_size - 1) / grid->cell_size);
+    grid->rows = MAX(1, (height + grid->cell_size - 1) / grid->cell_size);
+
+    u32 num_cells = grid->cols * grid->rows;
+    grid->cell_starts = PUSH_ARRAY(arena, u32, num_cells + 1);
+
+    // Counting the segments in each cell first
+    for (u32 i = 0; i < num_segments; i++) {
+        u32 range[4] = { 0 };
+        if (!_tt_sdf_cell_range(grid, &segments[i], width, height, dist_px_range, range)) {
+            continue;
+        }
+
+        for (u32 y = range[1]; y <= range[3]; y++) {
+            for (u32 x = range[0]; x <= range[2]; x++) {
+                grid->cell_starts[x + y * grid->cols + 1]++;
+            }
+        }
+    }
+
+    for (u32 i = 0; i < num_cells; i++) {
+        grid->cell_starts[i + 1] += grid->cell_starts[i];
+    }
+
+    grid->cell_segments = PUSH_ARRAY_NZ(arena, u32, grid->cell_starts[num_cells]);
+
+    mem_arena_temp temp = arena_temp_begin(arena);
+
+    u32* cell_fill = PUSH_ARRAY_NZ(arena, u32, num_cells);
+    memcpy(cell_fill, grid->cell_starts, sizeof(u32) * num_cells);
+
+    for (u32 i = 0; i < num_segments; i++) {
+        u32 range[4] = { 0 };
+        if (!_tt_sdf_cell_range(grid, &segments[i], width, height, dist_px_range, range)) {
+            continue;
+        }
+
+        for (u32 y = range[1]; y <= range[3]; y++) {
+            for (u32 x = range[0]; x <= range[2]; x++) {
+                grid->cell_segments[cell_fill[x + y * grid->cols]++] = i;
+            }
+        }
+    }
+
+    arena_temp_end(temp);
+}
+
+// Grid with a single cell listing every segment
+void _tt_sdf_grid_build_brute_force(
+    mem_arena* arena, _tt_sdf_grid* grid, u32 num_segments, u32 width, u32 height
+) {
+    grid->cell_size = MAX(1, MAX(width, height));
+    grid->cols = 1;
+    grid->rows = 1;
+
+    grid->cell_starts = PUSH_ARRAY(arena, u32, 2);
+    grid->cell_starts[1] = num_segments;
+
+    grid->cell_segments = PUSH_ARRAY_NZ(arena, u32, num_segments);
+    for (u32 i = 0; i < num_segments; i++) {
+        grid->cell_segments[i] = i;
+    }
+}
+
+// Number of Newton iterations used by the SIMD kernels
+// to find the closest point on a quadratic
+#define _TT_SDF_NEWTON_ITERS 4
+
+// Span functions write the min distance of `count` pixels of row `y`,
+// starting at `x_start`, to the segments in `list`
+// `out` must have room for `count` rounded up to a multiple of 8
+
+void _tt_sdf_span_scalar(
+    const tt_segment* segments, const u32* list, u32 num,
+    u32 y, u32 x_start, u32 count, f32* out
+) {
+    for (u32 x = 0; x < count; x++) {
+        v2_f32 p = { (f32)(x_start + x) + 0.5f, (f32)y + 0.5f };
+
+        f32 min_dist = INFINITY;
+
+        for (u32 i = 0; i < num; i++) {
+            f32 dist = tt_segment_dist(&segments[list[i]], p);
+            min_dist = MIN(min_dist, dist);
+        }
+
+        out[x] = min_dist;
+    }
+}
+
+// The SIMD kernels work on squared distances, and find the closest point
+// on quadratics with Newton's method on the derivative of the squared
+// distance (the same cubic the scalar path solves in closed form).
+// Iterations start at both ends and the middle of the curve,
+// and are clamped to [0, 1], so there are no per pixel branches
+
+#if defined(ARCH_X64)
+
+void _tt_sdf_span_sse2(
+    const tt_segment* segments, const u32* list, u32 num,
+    u32 y, u32 x_start, u32 count, f32* out
+) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 three = _mm_set1_ps(3.0f);
+    const __m128 lane_offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+    __m128 p_y = _mm_set1_ps((f32)y + 0.5f);
+
+    for (u32 x = 0; x < count; x += 4) {
+        __m128 p_x = _mm_add_ps(_mm_set1_ps((f32)(x_start + x)), lane_offsets);
+
+        __m128 min_dist2 = _mm_set1_ps(INFINITY);
+
+        for (u32 i = 0; i < num; i++) {
+            const tt_segment* seg = &segments[list[i]];
+
+            __m128 c0_x = _mm_sub_ps(p_x, _mm_set1_ps(seg->p0_x));
+            __m128 c0_y = _mm_sub_ps(p_y, _mm_set1_ps(seg->p0_y));
+            __m128 c1_x = _mm_set1_ps(seg->c1_x);
+            __m128 c1_y = _mm_set1_ps(seg->c1_y);
+
+            __m128 dist2;
+
+            if (seg->flags & TT_POINT_FLAG_LINE) {
+                __m128 t = _mm_mul_ps(
+                    _mm_add_ps(_mm_mul_ps(c0_x, c1_x), _mm_mul_ps(c0_y, c1_y)),
+                    _mm_set1_ps(seg->inv_a)
+                );
+                t = _mm_min_ps(_mm_max_ps(t, zero), one);
+
+                __m128 d_x = _mm_sub_ps(c0_x, _mm_mul_ps(c1_x, t));
+                __m128 d_y = _mm_sub_ps(c0_y, _mm_mul_ps(c1_y, t));
+
+                dist2 = _mm_add_ps(_mm_mul_ps(d_x, d_x), _mm_mul_ps(d_y, d_y));
+            } else {
+                __m128 c2_x = _mm_set1_ps(seg->c2_x);
+                __m128 c2_y = _mm_set1_ps(seg->c2_y);
+
+                __m128 a = _mm_set1_ps(seg->a);
+                __m128 b = _mm_set1_ps(seg->b);
+                __m128 c = _mm_sub_ps(
+                    _mm_set1_ps(seg->c_base),
+                    _mm_add_ps(_mm_mul_ps(c2_x, c0_x), _mm_mul_ps(c2_y, c0_y))
+                );
+                __m128 d = _mm_sub_ps(
+                    zero, _mm_add_ps(_mm_mul_ps(c1_x, c0_x), _mm_mul_ps(c1_y, c0_y))
+                );
+
+                __m128 a3 = _mm_mul_ps(a, three);
+                __m128 b2 = _mm_mul_ps(b, two);
+
+                __m128 ts[3] = { zero, _mm_set1_ps(0.5f), one };
+
+                for (u32 iter = 0; iter < _TT_SDF_NEWTON_ITERS; iter++) {
+                    for (u32 j = 0; j < 3; j++) {
+                        __m128 t = ts[j];
+
+                        __m128 f = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(
+                            _mm_add_ps(_mm_mul_ps(a, t), b), t), c), t), d);
+                        __m128 df = _mm_add_ps(_mm_mul_ps(
+                            _mm_add_ps(_mm_mul_ps(a3, t), b2), t), c);
+
+                        // Flat spots are left alone
+                        __m128 step = _mm_and_ps(
+                            _mm_div_ps(f, df), _mm_cmpneq_ps(df, zero)
+                        );
+
+                        t = _mm_sub_ps(t, step);
+                        ts[j] = _mm_min_ps(_mm_max_ps(t, zero), one);
+                    }
+                }
+
+                __m128 c1_x2 = _mm_mul_ps(c1_x, two);
+                __m128 c1_y2 = _mm_mul_ps(c1_y, two);
+
+                dist2 = _mm_set1_ps(INFINITY);
+
+                for (u32 j = 0; j < 3; j++) {
+                    __m128 t = ts[j];
+
+                    // (c2 * t + 2 * c1) * t - c0
+                    __m128 d_x = _mm_sub_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(c2_x, t), c1_x2), t), c0_x);
+                    __m128 d_y = _mm_sub_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(c2_y, t), c1_y2), t), c0_y);
+
+                    dist2 = _mm_min_ps(
+                        dist2, _mm_add_ps(_mm_mul_ps(d_x, d_x), _mm_mul_ps(d_y, d_y))
+                    );
+                }
+            }
+
+            min_dist2 = _mm_min_ps(min_dist2, dist2);
+        }
+
+        _mm_storeu_ps(out + x, _mm_sqrt_ps(min_dist2));
+    }
+}
+
+SIMD_TARGET_AVX2 void _tt_sdf_span_avx2(
+    const tt_segment* segments, const u32* list, u32 num,
+    u32 y, u32 x_start, u32 count, f32* out
+) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 three = _mm256_set1_ps(3.0f);
+    const __m256 lane_offsets = _mm256_setr_ps(
+        0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f
+    );
+
+    __m256 p_y = _mm256_set1_ps((f32)y + 0.5f);
+
+    for (u32 x = 0; x < count; x += 8) {
+        __m256 p_x = _mm256_add_ps(_mm256_set1_ps((f32)(x_start + x)), lane_offsets);
+
+        __m256 min_dist2 = _mm256_set1_ps(INFINITY);
+
+        for (u32 i = 0; i < num; i++) {
+            const tt_segment* seg = &segments[list[i]];
+
+            __m256 c0_x = _mm256_sub_ps(p_x, _mm256_set1_ps(seg->p0_x));
+            __m256 c0_y = _mm256_sub_ps(p_y, _mm256_set1_ps(seg->p0_y));
+            __m256 c1_x = _mm256_set1_ps(seg->c1_x);
+            __m256 c1_y = _mm256_set1_ps(seg->c1_y);
+
+            __m256 dist2;
+
+            if (seg->flags & TT_POINT_FLAG_LINE) {
+                __m256 t = _mm256_mul_ps(
+                    _mm256_fmadd_ps(c0_x, c1_x, _mm256_mul_ps(c0_y, c1_y)),
+                    _mm256_set1_ps(seg->inv_a)
+                );
+                t = _mm256_min_ps(_mm256_max_ps(t, zero), one);
+
+                __m256 d_x = _mm256_fnmadd_ps(c1_x, t, c0_x);
+                __m256 d_y = _mm256_fnmadd_ps(c1_y, t, c0_y);
+
+                dist2 = _mm256_fmadd_ps(d_x, d_x, _mm256_mul_ps(d_y, d_y));
+            } else {
+                __m256 c2_x = _mm256_set1_ps(seg->c2_x);
+                __m256 c2_y = _mm256_set1_ps(seg->c2_y);
+
+                __m256 a = _mm256_set1_ps(seg->a);
+                __m256 b = _mm256_set1_ps(seg->b);
+                __m256 c = _mm256_sub_ps(
+                    _mm256_set1_ps(seg->c_base),
+                    _mm256_fmadd_ps(c2_x, c0_x, _mm256_mul_ps(c2_y, c0_y))
+                );
+                __m256 d = _mm256_sub_ps(
+                    zero, _mm256_fmadd_ps(c1_x, c0_x, _mm256_mul_ps(c1_y, c0_y))
+                );
+
+                __m256 a3 = _mm256_mul_ps(a, three);
+                __m256 b2 = _mm256_mul_ps(b, two);
+
+                __m256 ts[3] = { zero, _mm256_set1_ps(0.5f), one };
+
+                for (u32 iter = 0; iter < _TT_SDF_NEWTON_ITERS; iter++) {
+                    for (u32 j = 0; j < 3; j++) {
+                        __m256 t = ts[j];
+
+                        __m256 f = _mm256_fmadd_ps(_mm256_fmadd_ps(
+                            _mm256_fmadd_ps(a, t, b), t, c), t, d);
+                        __m256 df = _mm256_fmadd_ps(_mm256_fmadd_ps(a3, t, b2), t, c);
+
+                        __m256 step = _mm256_and_ps(
+                            _mm256_div_ps(f, df), _mm256_cmp_ps(df, zero, _CMP_NEQ_UQ)
+                        );
+
+                        t = _mm256_sub_ps(t, step);
+                        ts[j] = _mm256_min_ps(_mm256_max_ps(t, zero), one);
+                    }
+                }
+
+                __m256 c1_x2 = _mm256_mul_ps(c1_x, two);
+                __m256 c1_y2 = _mm256_mul_ps(c1_y, two);
+
+                dist2 = _mm256_set1_ps(INFINITY);
+
+                for (u32 j = 0; j < 3; j++) {
+                    __m256 t = ts[j];
+
+                    __m256 d_x = _mm256_fmsub_ps(_mm256_fmadd_ps(c2_x, t, c1_x2), t, c0_x);
+                    __m256 d_y = _mm256_fmsub_ps(_mm256_fmadd_ps(c2_y, t, c1_y2), t, c0_y);
+
+                    dist2 = _mm256_min_ps(
+                        dist2, _mm256_fmadd_ps(d_x, d_x, _mm256_mul_ps(d_y, d_y))
+                    );
+                }
+            }
+
+            min_dist2 = _mm256_min_ps(min_dist2, dist2);
+        }
+
+        _mm256_storeu_ps(out + x, _mm256_sqrt_ps(min_dist2));
+    }
+}
+
+#elif defined(ARCH_ARM64)
+
+void _tt_sdf_span_neon(
+    const tt_segment* segments, const u32* list, u32 num,
+    u32 y, u32 x_start, u32 count, f32* out
+) {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const f32 lane_offsets_arr[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+    const float32x4_t lane_offsets = vld1q_f32(lane_offsets_arr);
+
+    float32x4_t p_y = vdupq_n_f32((f32)y + 0.5f);
+
+    for (u32 x = 0; x < count; x += 4) {
+        float32x4_t p_x = vaddq_f32(vdupq_n_f32((f32)(x_start + x)), lane_offsets);
+
+        float32x4_t min_dist2 = vdupq_n_f32(INFINITY);
+
+        for (u32 i = 0; i < num; i++) {
+            const tt_segment* seg = &segments[list[i]];
+
+            float32x4_t c0_x = vsubq_f32(p_x, vdupq_n_f32(seg->p0_x));
+            float32x4_t c0_y = vsubq_f32(p_y, vdupq_n_f32(seg->p0_y));
+
+            float32x4_t dist2;
+
+            if (seg->flags & TT_POINT_FLAG_LINE) {
+                float32x4_t t = vmulq_n_f32(
+                    vfmaq_n_f32(vmulq_n_f32(c0_y, seg->c1_y), c0_x, seg->c1_x),
+                    seg->inv_a
+                );
+                t = vminq_f32(vmaxq_f32(t, zero), one);
+
+                float32x4_t d_x = vfmsq_n_f32(c0_x, t, seg->c1_x);
+                float32x4_t d_y = vfmsq_n_f32(c0_y, t, seg->c1_y);
+
+                dist2 = vfmaq_f32(vmulq_f32(d_y, d_y), d_x, d_x);
+            } else {
+                float32x4_t a = vdupq_n_f32(seg->a);
+                float32x4_t b = vdupq_n_f32(seg->b);
+                float32x4_t c = vsubq_f32(
+                    vdupq_n_f32(seg->c_base),
+                    vfmaq_n_f32(vmulq_n_f32(c0_y, seg->c2_y), c0_x, seg->c2_x)
+                );
+                float32x4_t d = vnegq_f32(
+                    vfmaq_n_f32(vmulq_n_f32(c0_y, seg->c1_y), c0_x, seg->c1_x)
+                );
+
+                float32x4_t a3 = vdupq_n_f32(seg->a * 3.0f);
+                float32x4_t b2 = vdupq_n_f32(seg->b * 2.0f);
+
+                float32x4_t ts[3] = { zero, vdupq_n_f32(0.5f), one };
+
+                for (u32 iter = 0; iter < _TT_SDF_NEWTON_ITERS; iter++) {
+                    for (u32 j = 0; j < 3; j++) {
+                        float32x4_t t = ts[j];
+
+                        float32x4_t f = vfmaq_f32(d, vfmaq_f32(c, vfmaq_f32(b, a, t), t), t);
+                        float32x4_t df = vfmaq_f32(c, vfmaq_f32(b2, a3, t), t);
+
+                        uint32x4_t nonzero = vmvnq_u32(vceqq_f32(df, zero));
+                        float32x4_t step = vreinterpretq_f32_u32(vandq_u32(
+                            vreinterpretq_u32_f32(vdivq_f32(f, df)), nonzero
+                        ));
+
+                        t = vsubq_f32(t, step);
+                        ts[j] = vminq_f32(vmaxq_f32(t, zero), one);
+                    }
+                }
+
+                float32x4_t c1_x2 = vdupq_n_f32(seg->c1_x * 2.0f);
+                float32x4_t c1_y2 = vdupq_n_f32(seg->c1_y * 2.0f);
+
+                dist2 = vdupq_n_f32(INFINITY);
+
+                for (u32 j = 0; j < 3; j++) {
+                    float32x4_t t = ts[j];
+
+                    float32x4_t d_x = vsubq_f32(
+                        vmulq_f32(vfmaq_n_f32(c1_x2, t, seg->c2_x), t), c0_x
+                    );
+                    float32x4_t d_y = vsubq_f32(
+                        vmulq_f32(vfmaq_n_f32(c1_y2, t, seg->c2_y), t), c0_y
+                    );
+
+                    dist2 = vminq_f32(dist2, vfmaq_f32(vmulq_f32(d_y, d_y), d_x, d_x));
+                }
+            }
+
+            min_dist2 = vminq_f32(min_dist2, dist2);
+        }
+
+        vst1q_f32(out + x, vsqrtq_f32(min_dist2));
+    }
+}
+
+#endif
+
+void _tt_sdf_span(
+    const tt_segment* segments, const u32* list, u32 num, u32 y, u32 x_start, u32 count, f32* out
+) {
+    switch (simd_get_level()) {
+#if defined(ARCH_X64)
+        case SIMD_LEVEL_AVX2: _tt_sdf_span_avx2(segments, list, num, y, x_start, count, out); break;
+        case SIMD_LEVEL_SSE2: _tt_sdf_span_sse2(segments, list, num, y, x_start, count, out); break;
+#elif defined(ARCH_ARM64)
+        case SIMD_LEVEL_NEON: _tt_sdf_span_neon(segments, list, num, y, x_start, count, out); break;
+#endif
+        default: _tt_sdf_span_scalar(segments, list, num, y, x_start, count, out); break;
+    }
+}
+
+// Crossing of an outline with the horizontal line through a row of pixel centers
+typedef struct {
+    f32 x;
+    // +1 if the outline goes down (+y), -1 if it goes up
+    i32 winding;
+} _tt_sdf_crossing;
+
+// Solves `a * t^2 + b * t + c = 0` for the root in [t_min, t_max],
+// where the caller knows there is exactly one
+f32 _tt_sdf_solve_monotonic(f32 a, f32 b, f32 c, f32 t_min, f32 t_max) {
+    f32 t = 0.0f;
+
+    if (a == 0.0f) {
+        t = b == 0.0f ? t_min : -c / b;
+    } else {
+        // Avoiding the cancellation in `-b + sqrt(discr)`
+        f32 q = -0.5f * (b + copysignf(sqrtf(MAX(0.0f, b * b - 4.0f * a * c)), b));
+
+        f32 t0 = q / a;
+        f32 t1 = q == 0.0f ? t0 : c / q;
+
+        // The root furthest from the interval is the wrong one
+        f32 err0 = MAX(t_min - t0, t0 - t_max);
+        f32 err1 = MAX(t_min - t1, t1 - t_max);
+
+        t = err0 <= err1 ? t0 : t1;
+    }
+
+    return CLAMP(t, t_min, t_max);
+}
+
+// Writes the crossings of `seg` with the horizontal line at `y`
+// Returns the number of crossings, at most 2
+// Crossings are counted on half open intervals in y, so outlines
+// passing through `y` at a point between two segments count once
+u32 _tt_sdf_segment_crossings(const tt_segment* seg, f32 y, _tt_sdf_crossing* out) {
+    v2_f32 p0 = { seg->p0_x, seg->p0_y };
+    v2_f32 c1 = { seg->c1_x, seg->c1_y };
+
+    if (seg->flags & TT_POINT_FLAG_LINE) {
+        f32 p1_y = p0.y + c1.y;
+
+        if ((p0.y <= y) == (p1_y <= y)) { return 0; }
+
+        out[0] = (_tt_sdf_crossing){
+            .x = p0.x + (y - p0.y) / c1.y * c1.x,
+            .winding = c1.y > 0.0f ? 1 : -1,
+        };
+
+        return 1;
+    }
+
+    v2_f32 c2 = { seg->c2_x, seg->c2_y };
+    f32 p2_y = p0.y + 2.0f * c1.y + c2.y;
+
+    // Splitting the curve where it turns around in y,
+    // so each piece crosses the line at most once
+    f32 ts[3] = { 0.0f, 1.0f, 1.0f };
+    f32 ys[3] = { p0.y, p2_y, p2_y };
+    u32 num_pieces = 1;
+
+    if (c2.y != 0.0f) {
+        f32 t_turn = -c1.y / c2.y;
+
+        if (t_turn > 0.0f && t_turn < 1.0f) {
+            ts[1] = t_turn;
+            ys[1] = p0.y + (2.0f * c1.y + c2.y * t_turn) * t_turn;
+            num_pieces = 2;
+        }
+    }
+
+    u32 num_crossings = 0;
+
+    for (u32 i = 0; i < num_pieces; i++) {
+        f32 y0 = ys[i];
+        f32 y1 = ys[i + 1];
+
+        if ((y0 <= y) == (y1 <= y)) { continue; }
+
+        f32 t = _tt_sdf_solve_monotonic(
+            c2.y, 2.0f * c1.y, p0.y - y, ts[i], ts[i + 1]
+        );
+
+        out[num_crossings++] = (_tt_sdf_crossing){
+            .x = p0.x + (2.0f * c1.x + c2.x * t) * t,
+            .winding = y1 > y0 ? 1 : -1,
+        };
+    }
+
+    return num_crossings;
+}
+
+// Number of bitmap rows in each job when rendering with a job system
+#define _TT_SDF_TILE_ROWS 16
+
+// Everything needed to render the rows of one glyph
+typedef struct {
+    const tt_sdf_job* job;
+
+    u32 width, height;
+    // Top left of the glyph's scaled bounding box
+    v2_f32 min_scaled;
+
+    tt_segment* segments;
+    _tt_sdf_grid grid;
+
+    // Segments that can cross row `i` are
+    // `row_segments[row_starts[i]..row_starts[i + 1]]`
+    u32* row_starts;
+    u32* row_segments;
+    u32 max_row_segments;
+} _tt_sdf_glyph;
+
+// Gets the range of rows whose pixel centers are within the segment's y range
+// Returns false if there are none
+b32 _tt_sdf_segment_rows(const tt_segment* seg, u32 height, u32* first, u32* last) {
+    f32 first_row = ceilf(seg->min_y - 0.5f);
+    f32 last_row = floorf(seg->max_y - 0.5f);
+
+    if (height == 0 || last_row < 0.0f || first_row > (f32)(height - 1) || first_row > last_row) {
+        return false;
+    }
+
+    *first = (u32)MAX(first_row, 0.0f);
+    *last = (u32)MIN(last_row, (f32)(height - 1));
+
+    return true;
+}
+
+void _tt_sdf_row_buckets_build(mem_arena* arena, _tt_sdf_glyph* sdf, u32 num_segments) {
+    u32 height = sdf->height;
+
+    sdf->row_starts = PUSH_ARRAY(arena, u32, height + 1);
+
+    for (u32 i = 0; i < num_segments; i++) {
+        u32 first = 0, last = 0;
+        if (!_tt_sdf_segment_rows(&sdf->segments[i], height, &first, &last)) { continue; }
+
+        for (u32 y = first; y <= last; y++) {
+            sdf->row_starts[y + 1]++;
+        }
+    }
+
+    for (u32 y = 0; y < height; y++) {
+        sdf->max_row_segments = MAX(sdf->max_row_segments, sdf->row_starts[y + 1]);
+        sdf->row_starts[y + 1] += sdf->row_starts[y];
+    }
+
+    sdf->row_segments = PUSH_ARRAY_NZ(arena, u32, sdf->row_starts[height]);
+
+    mem_arena_temp temp = arena_temp_begin(arena);
+
+    u32* row_fill = PUSH_ARRAY_NZ(arena, u32, height);
+    memcpy(row_fill, sdf->row_starts, sizeof(u32) * height);
+
+    for (u32 i = 0; i < num_segments; i++) {
+        u32 first = 0, last = 0;
+        if (!_tt_sdf_segment_rows(&sdf->segments[i], height, &first, &last)) { continue; }
+
+        for (u32 y = first; y <= last; y++) {
+            sdf->row_segments[row_fill[y]++] = i;
+        }
+    }
+
+    arena_temp_end(temp);
+}
+
+// Returns false if there is nothing to render
+b32 _tt_sdf_glyph_prepare(mem_arena* arena, const tt_sdf_job* job, _tt_sdf_glyph* out) {
+    const bitmap_r8* bmp = job->bmp;
+    const tt_glyph_data* glyph = job->glyph;
+    v2_i32 offset = job->offset;
+    f32 scale = job->scale;
+    u32 padding = job->padding;
+
+    if (
+        offset.x < 0 || offset.x >= (i32)bmp->width ||
+        offset.y < 0 || offset.y >= (i32)bmp->height
+    ) {
+        return false;
+    }
+
+    f32 x_min_scaled = (f32)glyph->x_min *  scale;
+    f32 x_max_scaled = (f32)glyph->x_max *  scale;
+
+    // TTF uses +y up, bitmaps use +y down
+    // hence the switch
+    f32 y_min_scaled = (f32)glyph->y_max * -scale;
+    f32 y_max_scaled = (f32)glyph->y_min * -scale;
+
+    u32 width = (u32)ceilf(x_max_scaled - x_min_scaled) + padding * 2;
+    u32 height = (u32)ceilf(y_max_scaled - y_min_scaled) + padding * 2;
+
+    *out = (_tt_sdf_glyph){
+        .job = job,
+        .width = MIN(width, bmp->width - (u32)offset.x),
+        .height = MIN(height, bmp->height - (u32)offset.y),
+        .min_scaled = { x_min_scaled, y_min_scaled },
+    };
+
+    // The fast mode works on its own higher resolution outline
+    if (job->mode == TT_SDF_MODE_FAST) { return true; }
+
+    u32 num_segments = _tt_sdf_segments(
+        arena, glyph, scale, out->min_scaled, padding, &out->segments
+    );
+
+    if (job->flags & TT_SDF_FLAG_BRUTE_FORCE) {
+        _tt_sdf_grid_build_brute_force(arena, &out->grid, num_segments, out->width, out->height);
+    } else {
+        // Only segments near a pixel can be within the distance range,
+        // anything further is clamped anyway
+        _tt_sdf_grid_build(
+            arena, &out->grid, out->segments, num_segments,
+            out->width, out->height, job->dist_px_range
+        );
+    }
+
+    _tt_sdf_row_buckets_build(arena, out, num_segments);
+
+    return true;
+}
+
+// Gets the crossings of row `y`, sorted by x
+// Returns the number of crossings
+u32 _tt_sdf_row_crossings(const _tt_sdf_glyph* sdf, u32 y, _tt_sdf_crossing* crossings) {
+    f32 row_y = (f32)y + 0.5f;
+
+    u32 num_crossings = 0;
+    for (u32 i = sdf->row_starts[y]; i < sdf->row_starts[y + 1]; i++) {
+        num_crossings += _tt_sdf_segment_crossings(
+            &sdf->segments[sdf->row_segments[i]], row_y, crossings + num_crossings
+        );
+    }
+
+    // Rows only have a handful of crossings
+    for (u32 i = 1; i < num_crossings; i++) {
+        _tt_sdf_crossing crossing = crossings[i];
+
+        u32 j = i;
+        for (; j > 0 && crossings[j - 1].x > crossing.x; j--) {
+            crossings[j] = crossings[j - 1];
+        }
+
+        crossings[j] = crossing;
+    }
+
+    return num_crossings;
+}
+
+void _tt_sdf_glyph_render_rows(
+    mem_arena* arena, const _tt_sdf_glyph* sdf, u32 y_start, u32 y_end
+) {
+    const tt_sdf_job* job = sdf->job;
+    const _tt_sdf_grid* grid = &sdf->grid;
+
+    bitmap_r8* bmp = job->bmp;
+    f32 dist_px_range = job->dist_px_range;
+
+    mem_arena_temp temp = arena_temp_begin(arena);
+
+    // Spans may write up to 7 extra distances past the row
+    f32* row_dists = PUSH_ARRAY_NZ(arena, f32, sdf->width + 8);
+    _tt_sdf_crossing* crossings = PUSH_ARRAY_NZ(
+        arena, _tt_sdf_crossing, sdf->max_row_segments * 2
+    );
+
+    f32 dist_scale = 0.5f / dist_px_range;
+
+    for (u32 y_i = y_start; y_i < y_end; y_i++) {
+        u32 cell_y = y_i / grid->cell_size;
+
+        for (u32 x_i = 0; x_i < sdf->width; x_i += grid->cell_size) {
+            u32 cell = x_i / grid->cell_size + cell_y * grid->cols;
+            u32 cell_start = grid->cell_starts[cell];
+            u32 cell_end = grid->cell_starts[cell + 1];
+
+            _tt_sdf_span(
+                sdf->segments, grid->cell_segments + cell_start, cell_end - cell_start,
+                y_i, x_i, MIN(grid->cell_size, sdf->width - x_i), row_dists + x_i
+            );
+        }
+
+        u32 num_crossings = _tt_sdf_row_crossings(sdf, y_i, crossings);
+
+        u8* bmp_row = bmp->data + (u32)job->offset.x + (y_i + (u32)job->offset.y) * bmp->width;
+
+        // Walking the crossings left to right gives the winding number of each
+        // pixel, and pixels with a nonzero winding number are inside
+        i32 winding = 0;
+        u32 next_crossing = 0;
+
+        for (u32 x_i = 0; x_i < sdf->width; x_i++) {
+            f32 pixel_x = (f32)x_i + 0.5f;
+
+            while (next_crossing < num_crossings && crossings[next_crossing].x < pixel_x) {
+                winding += crossings[next_crossing++].winding;
+            }
+
+            f32 dist = MIN(row_dists[x_i], dist_px_range);
+            dist = winding != 0 ? dist : -dist;
+
+            bmp_row[x_i] = (u8)((dist * dist_scale + 0.5f) * 255.0f + 0.5f);
+        }
+    }
+
+    arena_temp_end(temp);
+}
+
+// Samples per pixel along each axis in the fast mode, must be even
+#define _TT_SDF_FAST_SUPERSAMPLE 4
+// Squared distance of samples with no feature, finite to avoid inf - inf
+#define _TT_SDF_FAST_FAR 1e20f
+
+// 1D squared Euclidean distance transform (Felzenszwalb and Huttenlocher)
+// `f` holds 0 at features and `_TT_SDF_FAST_FAR` elsewhere, and is replaced
+// by the squared distance to the nearest feature along `stride`
+// Only samples in the middle two of each `_TT_SDF_FAST_SUPERSAMPLE`
+// are written, since those are the only ones the pixels read
+// `verts` and `bounds` need room for `n` and `n + 1` elements
+void _tt_sdf_edt_1d(f32* f, u32 n, u32 stride, f32* tmp, u32* verts, f32* bounds) {
+    // Lower envelope of the parabolas rooted at each sample
+    // Samples without a feature never are on the envelope if any sample has one,
+    // and most samples are like that, so they are skipped
+    u32 k = 0;
+    u32 num_verts = 0;
+
+    for (u32 q = 0; q < n; q++) {
+        f32 fq = f[q * stride];
+        tmp[q] = fq;
+
+        if (fq >= _TT_SDF_FAST_FAR) { continue; }
+
+        if (num_verts == 0) {
+            verts[0] = q;
+            bounds[0] = -INFINITY;
+            bounds[1] = INFINITY;
+            num_verts = 1;
+            continue;
+        }
+
+        f32 s = 0.0f;
+
+        // `bounds[0]` is -inf, so this stops at k == 0
+        for (;;) {
+            f32 v = (f32)verts[k];
+            s = ((fq + (f32)q * (f32)q) - (tmp[verts[k]] + v * v)) / (2.0f * ((f32)q - v));
+
+            if (s > bounds[k]) { break; }
+            k--;
+        }
+
+        k++;
+        verts[k] = q;
+        bounds[k] = s;
+        bounds[k + 1] = INFINITY;
+    }
+
+    if (num_verts == 0) { return; }
+
+    const u32 ss = _TT_SDF_FAST_SUPERSAMPLE;
+
+    k = 0;
+    for (u32 q = ss / 2 - 1; q < n; q += (q % ss == ss / 2) ? ss - 1 : 1) {
+        while (bounds[k + 1] < (f32)q) {
+            k++;
+        }
+
+        f32 d = (f32)q - (f32)verts[k];
+        f[q * stride] = d * d + tmp[verts[k]];
+    }
+}
+
+// Rasterizes the outline into an inside mask at `_TT_SDF_FAST_SUPERSAMPLE`
+// times the resolution, then takes the distance from each sample to the
+// nearest sample on the edge of the mask
+void _tt_sdf_glyph_render_fast(mem_arena* arena, const _tt_sdf_glyph* sdf) {
+    const tt_sdf_job* job = sdf->job;
+
+    const u32 ss = _TT_SDF_FAST_SUPERSAMPLE;
+
+    mem_arena_temp temp = arena_temp_begin(arena);
+
+    _tt_sdf_glyph hi_res = {
+        .job = job,
+        .width = sdf->width * ss,
+        .height = sdf->height * ss,
+    };
+
+    u32 num_segments = _tt_sdf_segments(
+        arena, job->glyph, job->scale * (f32)ss,
+        v2_f32_scale(sdf->min_scaled, (f32)ss), job->padding * ss, &hi_res.segments
+    );
+    _tt_sdf_row_buckets_build(arena, &hi_res, num_segments);
+
+    u32 width = hi_res.width;
+    u32 height = hi_res.height;
+
+    b8* inside = PUSH_ARRAY_NZ(arena, b8, width * height);
+    f32* dists = PUSH_ARRAY_NZ(arena, f32, width * height);
+
+    _tt_sdf_crossing* crossings = PUSH_ARRAY_NZ(
+        arena, _tt_sdf_crossing, hi_res.max_row_segments * 2
+    );
+
+    for (u32 y = 0; y < height; y++) {
+        u32 num_crossings = _tt_sdf_row_crossings(&hi_res, y, crossings);
+
+        i32 winding = 0;
+        u32 next_crossing = 0;
+
+        for (u32 x = 0; x < width; x++) {
+            f32 sample_x = (f32)x + 0.5f;
+
+            while (next_crossing < num_crossings && crossings[next_crossing].x < sample_x) {
+                winding += crossings[next_crossing++].winding;
+            }
+
+            inside[x + y * width] = winding != 0;
+        }
+    }
+
+    // Samples next to a sample of the other kind are on the edge,
+    // about half a sample away from the outline
+    for (u32 y = 0; y < height; y++) {
+        for (u32 x = 0; x < width; x++) {
+            u32 i = x + y * width;
+            b8 in = inside[i];
+
+            b32 edge =
+                (x > 0 && inside[i - 1] != in) ||
+                (x < width - 1 && inside[i + 1] != in) ||
+                (y > 0 && inside[i - width] != in) ||
+                (y < height - 1 && inside[i + width] != in);
+
+            dists[i] = edge ? 0.0f : _TT_SDF_FAST_FAR;
+        }
+    }
+
+    // Pixel centers are between the four middle samples of the pixel,
+    // since `_TT_SDF_FAST_SUPERSAMPLE` is even
+    u32 center = ss / 2;
+
+    // 2D distance transform, as the 1D one along columns then rows
+    u32 max_dim = MAX(width, height);
+    f32* tmp = PUSH_ARRAY_NZ(arena, f32, max_dim);
+    u32* verts = PUSH_ARRAY_NZ(arena, u32, max_dim);
+    f32* bounds = PUSH_ARRAY_NZ(arena, f32, max_dim + 1);
+
+    for (u32 x = 0; x < width; x++) {
+        _tt_sdf_edt_1d(dists + x, height, width, tmp, verts, bounds);
+    }
+
+    for (u32 y = center - 1; y < height; y += (y % ss == center) ? ss - 1 : 1) {
+        _tt_sdf_edt_1d(dists + y * width, width, 1, tmp, verts, bounds);
+    }
+
+    bitmap_r8* bmp = job->bmp;
+    f32 dist_px_range = job->dist_px_range;
+    f32 dist_scale = 0.5f / dist_px_range;
+
+    for (u32 y_i = 0; y_i < sdf->height; y_i++) {
+        u8* bmp_row = bmp->data + (u32)job->offset.x + (y_i + (u32)job->offset.y) * bmp->width;
+
+        for (u32 x_i = 0; x_i < sdf->width; x_i++) {
+            f32 sum = 0.0f;
+
+            for (u32 sy = y_i * ss + center - 1; sy <= y_i * ss + center; sy++) {
+                for (u32 sx = x_i * ss + center - 1; sx <= x_i * ss + center; sx++) {
+                    u32 i = sx + sy * width;
+
+                    f32 dist = sqrtf(dists[i]) + 0.5f;
+                    sum += inside[i] ? dist : -dist;
+                }
+            }
+
+            f32 dist = sum * (0.25f / (f32)ss);
+            dist = CLAMP(dist, -dist_px_range, dist_px_range);
+
+            bmp_row[x_i] = (u8)((dist * dist_scale + 0.5f) * 255.0f + 0.5f);
+        }
+    }
+
+    arena_temp_end(temp);
+}
+
 void tt_render_glyph_sdf(
+    plat_job_system* job_system, bitmap_r8* bmp, v2_i32 offset,
+    tt_glyph_data* glyph, f32 scale, u32 padding, f32 dist_px_range
+) {
+    tt_sdf_job job = {
+        .bmp = bmp,
+        .offset = offset,
+        .glyph = glyph,
+        .scale = scale,
+        .padding = padding,
+        .dist_px_range = dist_px_range,
+    };
+
+    PROF_BEGIN("tt_render_glyph_sdf");
+
+    // Tiles of a single glyph are submitted the same way as a batch's
+    tt_render_glyphs_sdf(job_system, &job, 1);
+
+    PROF_END();
+}
+
+void tt_render_glyph_sdf_fast(
     bitmap_r8* bmp, v2_i32 offset, tt_glyph_data* glyph,
     f32 scale, u32 padding, f32 dist_px_range
+) {
+    tt_sdf_job job = {
+        .bmp = bmp,
+        .offset = offset,
+        .glyph = glyph,
+        .scale = scale,
+        .padding = padding,
+        .dist_px_range = dist_px_range,
+        .mode = TT_SDF_MODE_FAST,
+    };
+
+    PROF_BEGIN("tt_render_glyph_sdf_fast");
+
+    mem_arena_temp scratch = arena_scratch_get(NULL, 0);
+
+    _tt_sdf_glyph sdf = { 0 };
+    if (_tt_sdf_glyph_prepare(scratch.arena, &job, &sdf)) {
+        _tt_sdf_glyph_render_fast(scratch.arena, &sdf);
+    }
+
+    arena_scratch_release(scratch);
+
+    PROF_END();
+}
+
+// One job of `tt_render_glyphs_sdf`
+typedef struct {
+    const _tt_sdf_glyph* sdf;
+    u32 y_start, y_end;
+
+    // Arena the glyph was prepared on
+    mem_arena* glyph_arena;
+} _tt_sdf_tile;
+
+void _tt_sdf_render_tile(void* arg) {
+    _tt_sdf_tile* tile = (_tt_sdf_tile*)arg;
+
+    PROF_BEGIN("_tt_sdf_render_tile");
+
+    mem_arena_temp scratch = arena_scratch_get(&tile->glyph_arena, 1);
+
+    if (tile->sdf->job->mode == TT_SDF_MODE_FAST) {
+        _tt_sdf_glyph_render_fast(scratch.arena, tile->sdf);
+    } else {
+        _tt_sdf_glyph_render_rows(scratch.arena, tile->sdf, tile->y_start, tile->y_end);
+    }
+
+    arena_scratch_release(scratch);
+
+    PROF_END();
+}
+
+void tt_render_glyphs_sdf(
+    plat_job_system* job_system, const tt_sdf_job* jobs, u32 num_jobs
+) {
+    if (num_jobs == 0) { return; }
+
+    PROF_BEGIN("tt_render_glyphs_sdf");
+
+    mem_arena_temp scratch = arena_scratch_get(NULL, 0);
+
+    _tt_sdf_glyph* glyphs = PUSH_ARRAY(scratch.arena, _tt_sdf_glyph, num_jobs);
+    u32* tile_starts = PUSH_ARRAY(scratch.arena, u32, num_jobs + 1);
+
+    for (u32 i = 0; i < num_jobs; i++) {
+        u32 num_tiles = 0;
+
+        if (_tt_sdf_glyph_prepare(scratch.arena, &jobs[i], &glyphs[i])) {
+            // The fast mode works on the whole glyph at once
+            num_tiles = jobs[i].mode == TT_SDF_MODE_FAST ? 1 :
+                (glyphs[i].height + _TT_SDF_TILE_ROWS - 1) / _TT_SDF_TILE_ROWS;
+        }
+
+        tile_starts[i + 1] = tile_starts[i] + num_tiles;
+    }
+
+    _tt_sdf_tile* tiles = PUSH_ARRAY_NZ(scratch.arena, _tt_sdf_tile, tile_starts[num_jobs]);
+    plat_job_counter counter = { 0 };
+
+    for (u32 i = 0; i < num_jobs; i++) {
+        for (u32 t = tile_starts[i]; t < tile_starts[i + 1]; t++) {
+            u32 y_start = (t - tile_starts[i]) * _TT_SDF_TILE_ROWS;
+
+            tiles[t] = (_tt_sdf_tile){
+                .sdf = &glyphs[i],
+                .y_start = y_start,
+                .y_end = MIN(glyphs[i].height, y_start + _TT_SDF_TILE_ROWS),
+                .glyph_arena = scratch.arena,
+            };
+
+            plat_jobs_submit(job_system, _tt_sdf_render_tile, &tiles[t], &counter);
+        }
+    }
+
+    plat_jobs_wait(job_system, &counter);
+
+    arena_scratch_release(scratch);
+
+    PROF_END();
+}
+
+// Distances below this are considered equal when picking the closest segment
+#define _TT_MSDF_DIST_EPSILON 1e-6f
+// Min difference in pixels between neighboring channels for them to clash
+#define _TT_MSDF_CLASH_THRESH 1.001f
+
+typedef struct {
+    // Positive inside the glyph
+    f32 dist;
+    // How perpendicular the segment is to the pixel direction, in [0, 1]
+    // Breaks ties at corners shared by two segments
+    f32 ortho;
+
+    f32 t;
+    v2_f32 dir;
+} _tt_msdf_dist;
+
+b32 _tt_msdf_dist_less(_tt_msdf_dist a, _tt_msdf_dist b) {
+    f32 a_dist = fabsf(a.dist);
+    f32 b_dist = fabsf(b.dist);
+
+    if (fabsf(a_dist - b_dist) < _TT_MSDF_DIST_EPSILON) {
+        return a.ortho > b.ortho;
+    }
+
+    return a_dist < b_dist;
+}
+
+// Direction of the segment at `t`
+v2_f32 _tt_msdf_segment_dir(const tt_segment* seg, f32 t) {
+    v2_f32 c1 = { seg->c1_x, seg->c1_y };
+
+    if (seg->flags & TT_POINT_FLAG_LINE) {
+        return c1;
+    }
+
+    v2_f32 c2 = { seg->c2_x, seg->c2_y };
+    v2_f32 dir = v2_f32_add(c1, v2_f32_scale(c2, t));
+
+    // Control points on top of an end point, p2 - p0 = 2 * c1 + c2
+    if (dir.x == 0.0f && dir.y == 0.0f) {
+        dir = v2_f32_add(v2_f32_scale(c1, 2.0f), c2);
+    }
+
+    return dir;
+}
+
+_tt_msdf_dist _tt_msdf_segment_dist(const tt_segment* seg, v2_f32 p) {
+    f32 best_t = 0.0f;
+    f32 best_dist2 = _tt_segment_closest(seg, p, &best_t);
+    v2_f32 best_point = _tt_segment_point(seg, best_t);
+
+    v2_f32 dir = v2_f32_norm(_tt_msdf_segment_dir(seg, best_t));
+    v2_f32 to_point = v2_f32_sub(p, best_point);
+
+    f32 dist = sqrtf(best_dist2);
+    f32 cross = v2_f32_cross(dir, to_point);
+
+    // Outlines are clockwise with +y up, so with +y down
+    // the inside is on the positive side of the cross product
+    f32 sign = cross < 0.0f ? -1.0f : 1.0f;
+
+    return (_tt_msdf_dist){
+        .dist = sign * dist,
+        .ortho = dist > 0.0f ? fabsf(cross) / dist : 0.0f,
+        .t = best_t,
+        .dir = dir,
+    };
+}
+
+// Distance to the segment extended past its end points along their tangents
+// This keeps corners sharp, since the channels of a corner
+// come from different segments
+f32 _tt_msdf_pseudo_dist(const tt_segment* seg, v2_f32 p, _tt_msdf_dist dist) {
+    if (dist.t > 0.0f && dist.t < 1.0f) {
+        return dist.dist;
+    }
+
+    v2_f32 end_point = _tt_segment_point(seg, dist.t <= 0.0f ? 0.0f : 1.0f);
+
+    v2_f32 to_point = v2_f32_sub(p, end_point);
+    f32 along = v2_f32_dot(to_point, dist.dir);
+
+    // Only points past the end of the segment use the extension
+    if ((dist.t <= 0.0f && along < 0.0f) || (dist.t >= 1.0f && along > 0.0f)) {
+        f32 pseudo = v2_f32_cross(dist.dir, to_point);
+
+        if (fabsf(pseudo) <= fabsf(dist.dist)) {
+            return pseudo;
+        }
+    }
+
+    return dist.dist;
+}
+
+f32 _tt_median3(f32 a, f32 b, f32 c) {
+    return MAX(MIN(a, b), MIN(MAX(a, b), c));
+}
+
+// Checks if interpolating between pixels `a` and `b` would create an artifact,
+// i.e. two channels change a lot in opposite directions
+// Only `a` is flagged, and only if it is further from the outline than `b`
+b32 _tt_msdf_clash(const f32* a, const f32* b, f32 thresh) {
+    f32 a0 = a[0], a1 = a[1], a2 = a[2];
+    f32 b0 = b[0], b1 = b[1], b2 = b[2];
+    f32 tmp = 0.0f;
+
+    // Sorting the channels by how much they change
+#define _TT_SWAP(x, y) (tmp = (x), (x) = (y), (y) = tmp)
+    if (fabsf(b0 - a0) < fabsf(b1 - a1)) {
+        _TT_SWAP(a0, a1); _TT_SWAP(b0, b1);
+    }
+    if (fabsf(b1 - a1) < fabsf(b2 - a2)) {
+        _TT_SWAP(a1, a2); _TT_SWAP(b1, b2);
+
+        if (fabsf(b0 - a0) < fabsf(b1 - a1)) {
+            _TT_SWAP(a0, a1); _TT_SWAP(b0, b1);
+        }
+    }
+#undef _TT_SWAP
+
+    return fabsf(b1 - a1) >= thresh &&
+        // Pixels that were already corrected are not clashes
+        !(b0 == b1 && b0 == b2) &&
+        fabsf(a2) >= fabsf(b2);
+}
+
+// Replaces pixels that would cause artifacts when interpolated
+// by the median of their channels, or by the true distance if
+// the median has the wrong sign
+void _tt_msdf_correct(
+    mem_arena* arena, f32* dists, const f32* true_dists,
+    u32 width, u32 height
+) {
+    mem_arena_temp temp = arena_temp_begin(arena);
+
+    b8* clashes = PUSH_ARRAY(arena, b8, width * height);
+
+    for (u32 y = 0; y < height; y++) {
+        for (u32 x = 0; x < width; x++) {
+            u32 i = x + y * width;
+            const f32* d = dists + i * 3;
+
+            clashes[i] =
+                (x > 0 && _tt_msdf_clash(d, d - 3, _TT_MSDF_CLASH_THRESH)) ||
+                (x < width - 1 && _tt_msdf_clash(d, d + 3, _TT_MSDF_CLASH_THRESH)) ||
+                (y > 0 && _tt_msdf_clash(d, d - width * 3, _TT_MSDF_CLASH_THRESH)) ||
+                (y < height - 1 && _tt_msdf_clash(d, d + width * 3, _TT_MSDF_CLASH_THRESH));
+        }
+    }
+
+    for (u32 i = 0; i < width * height; i++) {
+        f32* d = dists + i * 3;
+        f32 median = _tt_median3(d[0], d[1], d[2]);
+
+        if ((median < 0.0f) != (true_dists[i] < 0.0f)) {
+            median = true_dists[i];
+        } else if (!clashes[i]) {
+            continue;
+        }
+
+        d[0] = d[1] = d[2] = median;
+    }
+
+    arena_temp_end(temp);
+}
+
+void tt_render_glyph_msdf(
+    bitmap_rgb8* bmp, v2_i32 offset, tt_glyph_data* glyph,
+    f32 scale, u32 padding, f32 dist_px_range
 ) {
     if (
         offset.x < 0 || offset.x >= (i32)bmp->width ||
@@ -13,8 +1271,6 @@ void tt_render_glyph_sdf(
     f32 x_min_scaled = (f32)glyph->x_min *  scale;
     f32 x_max_scaled = (f32)glyph->x_max *  scale;
 
-    // TTF uses +y up, bitmaps use +y down
-    // hence the switch
     f32 y_min_scaled = (f32)glyph->y_max * -scale;
     f32 y_max_scaled = (f32)glyph->y_min * -scale;
 
@@ -24,84 +1280,371 @@ void tt_render_glyph_sdf(
     width = MIN(width, bmp->width - (u32)offset.x);
     height = MIN(height, bmp->height - (u32)offset.y);
 
+    PROF_BEGIN("tt_render_glyph_msdf");
+
     mem_arena_temp scratch = arena_scratch_get(NULL, 0);
 
-    v2_f32* points = PUSH_ARRAY_NZ(scratch.arena, v2_f32, glyph->num_points);
-    for (u32 i = 0; i < glyph->num_points; i++) {
-        points[i].x = (f32)glyph->points[i].x *  scale - x_min_scaled + (f32)padding;
-        points[i].y = (f32)glyph->points[i].y * -scale - y_min_scaled + (f32)padding;
-    }
+    tt_segment* segments = NULL;
+    u32 num_segments = _tt_sdf_segments(
+        scratch.arena, glyph, scale,
+        (v2_f32){ x_min_scaled, y_min_scaled }, padding, &segments
+    );
 
+    f32* dists = PUSH_ARRAY_NZ(scratch.arena, f32, width * height * 3);
+    f32* true_dists = PUSH_ARRAY_NZ(scratch.arena, f32, width * height);
+
+    static const tt_point_flag channel_colors[3] = {
+        TT_POINT_FLAG_RED, TT_POINT_FLAG_GREEN, TT_POINT_FLAG_BLUE
+    };
+
+    // Every segment is checked for every pixel, since the sign
+    // comes from the closest segment, however far it is
     for (u32 y_i = 0; y_i < height; y_i++) {
-        for (u32 x_i = 0; x_i < height; x_i++) {
+        for (u32 x_i = 0; x_i < width; x_i++) {
             v2_f32 p = { (f32)x_i + 0.5f, (f32)y_i + 0.5f };
 
-            f32 min_dist = INFINITY;
+            _tt_msdf_dist closest = { .dist = INFINITY };
+            _tt_msdf_dist channel_closest[3] = {
+                { .dist = INFINITY }, { .dist = INFINITY }, { .dist = INFINITY }
+            };
+            u32 channel_segments[3] = { 0 };
 
-            u32 index = 0;
-            for (u32 seg = 0; seg < glyph->num_segments; seg++) {
-                f32 dist = INFINITY;
+            for (u32 i = 0; i < num_segments; i++) {
+                _tt_msdf_dist dist = _tt_msdf_segment_dist(&segments[i], p);
 
-                if (glyph->flags[index] & TT_POINT_FLAG_LINE) {
-                    v2_f32 p0 = points[index++];
-                    v2_f32 p1 = points[index];
+                if (_tt_msdf_dist_less(dist, closest)) {
+                    closest = dist;
+                }
 
-                    v2_f32 line_vec = v2_f32_sub(p1, p0);
-                    v2_f32 point_vec = v2_f32_sub(p, p0);
+                // Uncolored glyphs act as if every edge was white
+                tt_point_flag colors = segments[i].flags & _TT_WHITE;
+                if (colors == 0) { colors = _TT_WHITE; }
 
-                    f32 t = v2_f32_dot(point_vec, line_vec) / v2_f32_dot(line_vec, line_vec);
-                    t = CLAMP(t, 0.0f, 1.0f);
+                for (u32 c = 0; c < 3; c++) {
+                    if ((colors & channel_colors[c]) && _tt_msdf_dist_less(dist, channel_closest[c])) {
+                        channel_closest[c] = dist;
+                        channel_segments[c] = i;
+                    }
+                }
+            }
 
-                    v2_f32 line_point = v2_f32_add(p0, v2_f32_scale(line_vec, t));
-                    dist = v2_f32_dist(p, line_point);
-                } else {
-                    v2_f32 p0 = points[index++];
-                    v2_f32 p1 = points[index++];
-                    v2_f32 p2 = points[index];
-
-                    v2_f32 c0 = v2_f32_sub(p, p0);
-                    v2_f32 c1 = v2_f32_sub(p1, p0);
-                    v2_f32 c2 = v2_f32_add(p2, v2_f32_add(v2_f32_scale(p1, -2.0f), p0));
-
-                    f32 ts[3] = { 0 };
-                    u32 num_t = solve_cubic(
-                        ts,
-                        v2_f32_dot(c2, c2),
-                        3.0f * v2_f32_dot(c1, c2),
-                        2.0f * v2_f32_dot(c1, c1) - v2_f32_dot(c2, c0),
-                        -v2_f32_dot(c1, c0)
-                    );
+            // Glyphs without outlines (e.g. spaces) are all outside
+            if (num_segments == 0) {
+                closest.dist = -INFINITY;
+            }
 
-                    for (u32 i = 0; i < num_t; i++) {
-                        f32 t = CLAMP(ts[i], 0.0f, 1.0f);
+            u32 index = x_i + y_i * width;
+            true_dists[index] = closest.dist;
 
-                        v2_f32 bez_point = v2_f32_add(
-                            v2_f32_add(
-                                v2_f32_scale(c2, t * t),
-                                v2_f32_scale(c1, 2.0f * t)
-                            ), p0
-                        );
+            for (u32 c = 0; c < 3; c++) {
+                f32 dist = channel_closest[c].dist;
 
-                        f32 cur_dist = v2_f32_dist(p, bez_point);
-                        dist = MIN(dist, cur_dist);
-                    }
+                if (isfinite(dist)) {
+                    dist = _tt_msdf_pseudo_dist(&segments[channel_segments[c]], p, channel_closest[c]);
+                } else {
+                    // No edge of this color
+                    dist = closest.dist;
                 }
 
-                min_dist = MIN(min_dist, dist);
+                // Clashes are checked on what the texture will hold
+                dists[index * 3 + c] = CLAMP(dist, -dist_px_range, dist_px_range);
+            }
+        }
+    }
+
+    _tt_msdf_correct(scratch.arena, dists, true_dists, width, height);
+
+    for (u32 y_i = 0; y_i < height; y_i++) {
+        u8* bmp_row = bmp->data + ((u32)offset.x + (y_i + (u32)offset.y) * bmp->width) * 3;
+
+        for (u32 i = 0; i < width * 3; i++) {
+            f32 dist = CLAMP(dists[i + y_i * width * 3], -dist_px_range, dist_px_range);
+
+            bmp_row[i] = (u8)((dist / dist_px_range * 0.5f + 0.5f) * 255.0f + 0.5f);
+        }
+    }
+
+    arena_scratch_release(scratch);
+
+    PROF_END();
+}
+
+// Quadratics are flattened into lines that stay within this many pixels
+// of the curve
+#define _TT_COVERAGE_FLATTEN_TOL 0.02f
+
+// Adds the signed area and cover of a line to the accumulation buffer
+// Each cell holds the change in coverage from the previous cell,
+// so a prefix sum over the whole buffer gives the coverage
+void _tt_coverage_line(f32* acc, u32 width, u32 height, v2_f32 p0, v2_f32 p1) {
+    if (p0.y == p1.y) { return; }
+
+    f32 dir = 1.0f;
+    if (p0.y > p1.y) {
+        v2_f32 tmp = p0;
+        p0 = p1;
+        p1 = tmp;
+        dir = -1.0f;
+    }
+
+    f32 dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+    f32 x = p0.x;
+
+    if (p0.y < 0.0f) {
+        x -= p0.y * dxdy;
+    }
+
+    u32 y_start = (u32)MAX(0.0f, p0.y);
+    u32 y_end = (u32)MIN((f32)height, ceilf(p1.y));
+
+    for (u32 y = y_start; y < y_end; y++) {
+        f32* row = acc + y * width;
+
+        f32 dy = MIN((f32)(y + 1), p1.y) - MAX((f32)y, p0.y);
+        f32 x_next = x + dxdy * dy;
+        f32 d = dy * dir;
+
+        f32 x0 = MIN(x, x_next);
+        f32 x1 = MAX(x, x_next);
+
+        // Lines are inside the bitmap, up to rounding
+        x0 = CLAMP(x0, 0.0f, (f32)width);
+        x1 = CLAMP(x1, 0.0f, (f32)width);
+
+        f32 x0_floor = floorf(x0);
+        f32 x1_ceil = ceilf(x1);
+        u32 x0_i = (u32)x0_floor;
+        u32 x1_i = (u32)x1_ceil;
+
+        if (x1_i <= x0_i + 1) {
+            // The line stays in one pixel of the row
+            f32 x_mid = 0.5f * (x0 + x1) - x0_floor;
 
-                if (glyph->flags[index] & TT_POINT_FLAG_CONTOUR_END) {
-                    index++;
+            row[x0_i] += d - d * x_mid;
+            row[x0_i + 1] += d * x_mid;
+        } else {
+            f32 inv_dx = 1.0f / (x1 - x0);
+
+            f32 x0_frac = x0 - x0_floor;
+            f32 area_first = 0.5f * inv_dx * (1.0f - x0_frac) * (1.0f - x0_frac);
+
+            f32 x1_frac = x1 - x1_ceil + 1.0f;
+            f32 area_last = 0.5f * inv_dx * x1_frac * x1_frac;
+
+            row[x0_i] += d * area_first;
+
+            if (x1_i == x0_i + 2) {
+                row[x0_i + 1] += d * (1.0f - area_first - area_last);
+            } else {
+                f32 area_second = inv_dx * (1.5f - x0_frac);
+                row[x0_i + 1] += d * (area_second - area_first);
+
+                for (u32 x_i = x0_i + 2; x_i < x1_i - 1; x_i++) {
+                    row[x_i] += d * inv_dx;
                 }
+
+                f32 area_before_last = area_second + (f32)(x1_i - x0_i - 3) * inv_dx;
+                row[x1_i - 1] += d * (1.0f - area_before_last - area_last);
             }
 
-            f32 scaled_dist = CLAMP(min_dist, -dist_px_range, dist_px_range);
-            scaled_dist *= 255.0f / (dist_px_range);
+            row[x1_i] += d * area_last;
+        }
+
+        x = x_next;
+    }
+}
+
+void _tt_coverage_quad(f32* acc, u32 width, u32 height, v2_f32 p0, v2_f32 p1, v2_f32 p2) {
+    // The curve is at most |p0 - 2 * p1 + p2| / 4 away from its chord,
+    // and splitting it into n lines divides that by n^2
+    f32 dev_x = p0.x - 2.0f * p1.x + p2.x;
+    f32 dev_y = p0.y - 2.0f * p1.y + p2.y;
+    f32 dev = sqrtf(dev_x * dev_x + dev_y * dev_y) * 0.25f;
+
+    if (dev <= _TT_COVERAGE_FLATTEN_TOL) {
+        _tt_coverage_line(acc, width, height, p0, p2);
+        return;
+    }
+
+    u32 num_lines = (u32)ceilf(sqrtf(dev / _TT_COVERAGE_FLATTEN_TOL));
+    f32 dt = 1.0f / (f32)num_lines;
+
+    v2_f32 prev = p0;
+    for (u32 i = 1; i <= num_lines; i++) {
+        f32 t = (f32)i * dt;
+        f32 u = 1.0f - t;
 
-            u32 bmp_index = (x_i + (u32)offset.x) + (y_i + (u32)offset.y) * bmp->width;
-            bmp->data[bmp_index] = (u8)scaled_dist;
+        v2_f32 cur = i == num_lines ? p2 : (v2_f32){
+            u * u * p0.x + 2.0f * u * t * p1.x + t * t * p2.x,
+            u * u * p0.y + 2.0f * u * t * p1.y + t * t * p2.y,
+        };
+
+        _tt_coverage_line(acc, width, height, prev, cur);
+        prev = cur;
+    }
+}
+
+// Prefix sums `count` cells of the accumulation buffer into coverage values
+// `count` must be a multiple of 4 for the SIMD versions
+
+void _tt_coverage_accumulate_scalar(const f32* acc, u8* out, u32 count) {
+    f32 sum = 0.0f;
+
+    for (u32 i = 0; i < count; i++) {
+        sum += acc[i];
+
+        out[i] = (u8)(MIN(fabsf(sum), 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+#if defined(ARCH_X64)
+
+void _tt_coverage_accumulate_sse2(const f32* acc, u8* out, u32 count) {
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    __m128 offset = _mm_setzero_ps();
+
+    for (u32 i = 0; i < count; i += 4) {
+        __m128 x = _mm_loadu_ps(acc + i);
+
+        // Prefix sum within the register
+        x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+        x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+        x = _mm_add_ps(x, offset);
+
+        __m128 y = _mm_min_ps(_mm_and_ps(x, abs_mask), one);
+        __m128i values = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(y, scale), half));
+
+        // Packing the low byte of each lane
+        values = _mm_packs_epi32(values, values);
+        values = _mm_packus_epi16(values, values);
+
+        i32 packed = _mm_cvtsi128_si32(values);
+        memcpy(out + i, &packed, sizeof(packed));
+
+        offset = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+}
+
+#elif defined(ARCH_ARM64)
+
+void _tt_coverage_accumulate_neon(const f32* acc, u8* out, u32 count) {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+
+    float32x4_t offset = zero;
+
+    for (u32 i = 0; i < count; i += 4) {
+        float32x4_t x = vld1q_f32(acc + i);
+
+        // Prefix sum within the register
+        x = vaddq_f32(x, vextq_f32(zero, x, 3));
+        x = vaddq_f32(x, vextq_f32(zero, x, 2));
+        x = vaddq_f32(x, offset);
+
+        float32x4_t y = vminq_f32(vabsq_f32(x), one);
+        uint32x4_t values = vcvtq_u32_f32(vfmaq_n_f32(vdupq_n_f32(0.5f), y, 255.0f));
+
+        uint16x4_t values_16 = vmovn_u32(values);
+        uint8x8_t values_8 = vmovn_u16(vcombine_u16(values_16, values_16));
+
+        vst1_lane_u32((u32*)(void*)(out + i), vreinterpret_u32_u8(values_8), 0);
+
+        offset = vdupq_laneq_f32(x, 3);
+    }
+}
+
+#endif
+
+void _tt_coverage_accumulate(const f32* acc, u8* out, u32 count) {
+    switch (simd_get_level()) {
+#if defined(ARCH_X64)
+        // Lanes depend on each other, so AVX2 does not help much
+        case SIMD_LEVEL_AVX2:
+        case SIMD_LEVEL_SSE2: _tt_coverage_accumulate_sse2(acc, out, count); break;
+#elif defined(ARCH_ARM64)
+        case SIMD_LEVEL_NEON: _tt_coverage_accumulate_neon(acc, out, count); break;
+#endif
+        default: _tt_coverage_accumulate_scalar(acc, out, count); break;
+    }
+}
+
+void tt_render_glyph_coverage(
+    bitmap_r8* bmp, v2_i32 offset, tt_glyph_data* glyph, f32 scale
+) {
+    if (
+        offset.x < 0 || offset.x >= (i32)bmp->width ||
+        offset.y < 0 || offset.y >= (i32)bmp->height
+    ) {
+        return;
+    }
+
+    // Whole pixels, so the outline keeps its position within the pixel
+    v2_f32 origin = {
+        floorf((f32)glyph->x_min * scale),
+        floorf((f32)glyph->y_max * -scale),
+    };
+
+    u32 width = (u32)(ceilf((f32)glyph->x_max * scale) - origin.x);
+    u32 height = (u32)(ceilf((f32)glyph->y_min * -scale) - origin.y);
+
+    if (glyph->num_segments == 0 || width == 0 || height == 0) { return; }
+
+    PROF_BEGIN("tt_render_glyph_coverage");
+
+    mem_arena_temp scratch = arena_scratch_get(NULL, 0);
+
+    // Lines on the right edge write up to two cells past their row,
+    // and the SIMD accumulation works in groups of 4
+    u32 num_cells = ALIGN_UP_POW2(width * height + 2, 4);
+    f32* acc = PUSH_ARRAY(scratch.arena, f32, num_cells);
+    u8* coverage = PUSH_ARRAY_NZ(scratch.arena, u8, num_cells);
+
+    v2_f32 points[3] = { 0 };
+
+    u32 index = 0;
+    for (u32 seg = 0; seg < glyph->num_segments; seg++) {
+        u32 num_points = (glyph->flags[index] & TT_POINT_FLAG_LINE) ? 2 : 3;
+
+        for (u32 i = 0; i < num_points; i++) {
+            v2_i16 p = glyph->points[index + i];
+
+            points[i] = (v2_f32){
+                (f32)p.x *  scale - origin.x,
+                (f32)p.y * -scale - origin.y,
+            };
+        }
+
+        if (num_points == 2) {
+            _tt_coverage_line(acc, width, height, points[0], points[1]);
+        } else {
+            _tt_coverage_quad(acc, width, height, points[0], points[1], points[2]);
         }
+
+        index += num_points - 1;
+
+        if (glyph->flags[index] & TT_POINT_FLAG_CONTOUR_END) {
+            index++;
+        }
+    }
+
+    _tt_coverage_accumulate(acc, coverage, num_cells);
+
+    u32 copy_width = MIN(width, bmp->width - (u32)offset.x);
+    u32 copy_height = MIN(height, bmp->height - (u32)offset.y);
+
+    for (u32 y = 0; y < copy_height; y++) {
+        memcpy(
+            bmp->data + (u32)offset.x + (y + (u32)offset.y) * bmp->width,
+            coverage + y * width, copy_width
+        );
     }
 
     arena_scratch_release(scratch);
+
+    PROF_END();
 }
 
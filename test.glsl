@@ -16,16 +16,15 @@ struct instance_data {
 
 layout (location = 0) out vec4 out_col;
 
-layout (binding = 0, std430) readonly buffer glyph_ssbo {
-    uint glyph_packed[];
-};
-
 layout (binding = 1, std430) readonly buffer instance_ssbo {
     instance_data instances[];
 };
 
 flat in int glyph_id;
-in vec2 pos;
+in vec2 world_pos;
+
+// Fragment position in font units, segments are not transformed
+vec2 pos;
 
 #define POINT_FLAG_LINE        (1 << 0)
 #define POINT_FLAG_CONTOUR_END (1 << 1)
@@ -40,146 +39,109 @@ float cross(vec2 a, vec2 b) {
     return a.x * b.y - a.y * b.x;
 }
 
-#define EPSILON 1e-8
-#define PI 3.14159265358979323846
-
-float cbrt(float x) {
-    return sign(x) * pow(abs(x), 1.0/3.0);
-}
-
-vec2 solve_quadratic(float a, float b, float c) {
-    if (abs(a) < EPSILON || abs(b) > 1e6 * abs(a)) {
-        if (abs(b) < EPSILON) {
-            return vec2(0.0, 1.0);
-        }
+// Same members as `tt_segment`
+struct segment {
+    float p0_x, p0_y;
+    float c1_x, c1_y;
+    float c2_x, c2_y;
 
-        return vec2(-c / b, 0.0);
-    }
-
-    float discriminant = b * b - 4.0 * a * c;
-    if (discriminant > 0.0) {
-        float sqrt_discr = sqrt(discriminant);
-
-        return vec2(
-            (-b + sqrt_discr) / (2.0 * a),
-            (-b - sqrt_discr) / (2.0 * a)
-        );
-    } else if (abs(discriminant) < EPSILON) {
-        return vec2(-b / (2.0 * a), 0.0);
-    }
-
-    return vec2(0.0, 1.0);
-}
+    float min_x, min_y;
+    float max_x, max_y;
 
-// 0 = x^3 + (a2)(x^2) + (a1)(x) + a0
-// https://mathworld.wolfram.com/CubicFormula.html
-vec3 solve_cubic_normed(float a2, float a1, float a0) {
-    float a2_2 = a2 * a2;
+    float a, b, c_base;
 
-    float Q = (1.0/9.0) * (3.0 * a1 - a2_2);
-    float R = (1.0/54.0) * (9.0 * a2 * a1 - 27.0 * a0 - 2.0 * a2_2 * a2);
+    float inv_a;
+    float shift, p_base, q_base;
 
-    float R2 = R * R;
-    float Q3 = Q * Q * Q;
-
-    a2 *= 1.0/3.0;
-    if (R2 + Q3 < 0.0) {
-        float t = R / sqrt(-Q3);
-        t = clamp(t, -1.0, 1.0);
-
-        float theta = acos(t);
-
-        float coef = 2.0 * sqrt(-Q);
-
-        return vec3(
-            coef * cos(theta / 3.0) - a2,
-            coef * cos((theta + 2.0 * PI) / 3.0) - a2,
-            coef * cos((theta + 4.0 * PI) / 3.0) - a2
-        );
-    }
-
-    float S = cbrt(R + sqrt(R2 + Q3));
-    float T = cbrt(R - sqrt(R2 + Q3));
-
-    vec3 solutions = vec3((S + T) - a2, 1.0, 0.0);
-
-    if (abs(S - T) < EPSILON) {
-        solutions.x = -0.5f * (S + T) - a2;
-
-        return solutions;
-    }
+    uint flags;
+};
 
-    return solutions;
-}
+// In floats, `sizeof(tt_segment) / 4`
+#define SEGMENT_SIZE 18
 
-vec3 solve_cubic(float a, float b, float c, float d) {
-    if (abs(a) >= EPSILON) {
-        float b_a = b / a;
-        if (abs(b_a) < 1e6f) {
-            return solve_cubic_normed(b_a, c/a, d/a);
-        }
-    }
+// The glyph cache's pool, segments start at any multiple of 4 bytes
+layout (binding = 0, std430) readonly buffer glyph_ssbo {
+    float pool[];
+};
 
-    return vec3(solve_quadratic(b, c, d), 0.0);
+segment load_segment(uint i) {
+    return segment(
+        pool[i +  0], pool[i +  1],
+        pool[i +  2], pool[i +  3],
+        pool[i +  4], pool[i +  5],
+        pool[i +  6], pool[i +  7],
+        pool[i +  8], pool[i +  9],
+        pool[i + 10], pool[i + 11], pool[i + 12],
+        pool[i + 13],
+        pool[i + 14], pool[i + 15], pool[i + 16],
+        floatBitsToUint(pool[i + 17])
+    );
 }
 
-dist_info line_dist(vec2 p0, vec2 p1) {
-    vec2 line_vec = p1 - p0;
-    vec2 point_vec = pos - p0;
+dist_info make_dist(vec2 seg_point, vec2 dir, float t) {
+    vec2 to_point = pos - seg_point;
+    float dist = length(to_point);
 
-    float t = dot(point_vec, line_vec) / dot(line_vec, line_vec);
-    t = clamp(t, 0.0, 1.0);
+    vec2 point_dir = to_point / dist;
 
-    vec2 line_point = p0 + line_vec * t;
-    vec2 line_to_point = pos - line_point;
+    float ortho = cross(normalize(dir), point_dir);
+    float s = ortho < 0.0 ? -1 : 1;
 
-    float dist = length(line_to_point);
+    return dist_info(s * dist, s * ortho, t);
+}
 
-    vec2 line_dir = normalize(line_vec);
-    vec2 point_dir = line_to_point / dist;
+dist_info line_dist(segment seg) {
+    vec2 p0 = vec2(seg.p0_x, seg.p0_y);
+    vec2 c1 = vec2(seg.c1_x, seg.c1_y);
 
-    float ortho = cross(line_dir, point_dir);
-    float s = ortho < 0.0 ? -1 : 1;
+    float t = clamp(dot(pos - p0, c1) * seg.inv_a, 0.0, 1.0);
 
-    return dist_info(s * dist, s * ortho, t);
+    return make_dist(p0 + c1 * t, c1, t);
 }
 
-dist_info bez_dist(vec2 p0, vec2 p1, vec2 p2) {
+// See `_tt_segment_closest`
+dist_info bez_dist(segment seg) {
+    vec2 p0 = vec2(seg.p0_x, seg.p0_y);
+    vec2 c1 = vec2(seg.c1_x, seg.c1_y);
+    vec2 c2 = vec2(seg.c2_x, seg.c2_y);
     vec2 c0 = pos - p0;
-    vec2 c1 = p1 - p0;
-    vec2 c2 = p2 - 2.0 * p1 + p0;
 
-    float a = dot(c2, c2);
-    float b = 3.0 * dot(c1, c2);
-    float c = 2.0 * dot(c1, c1) - dot(c2, c0);
-    float d = -dot(c1, c0);
+    float c2_c0 = dot(c2, c0);
+    float c1_c0 = dot(c1, c0);
 
-    vec3 ts = solve_cubic(a, b, c, d);
+    // Depressed cubic u^3 + p u + q
+    float p = seg.p_base - c2_c0 * seg.inv_a;
+    float q = seg.q_base + (seg.shift * c2_c0 - c1_c0) * seg.inv_a;
 
-    float t = 0.0;
-    vec2 bez_to_point = vec2(0);
-    float dist = INFINITY;
+    float h = q * q * 0.25 + p * p * p * (1.0 / 27.0);
 
-    for (uint i = 0; i < 3; i++) {
-        float cur_t = clamp(ts[i], 0.0, 1.0);
-        vec2 cur_bez_point = cur_t * (cur_t * c2 + 2.0 * c1) + p0;
-        vec2 cur_bez_to_point = pos - cur_bez_point;
-        float cur_dist = length(cur_bez_to_point);
+    vec2 ts;
+    if (h >= 0.0) {
+        float r = -0.5 * q - (q < 0.0 ? -sqrt(h) : sqrt(h));
+        float w = sign(r) * pow(abs(r), 1.0 / 3.0);
 
-        if (cur_dist < dist) {
-            t = cur_t;
-            bez_to_point = cur_bez_to_point;
-            dist = cur_dist;
-        }
+        ts = vec2((w != 0.0 ? w - p / (3.0 * w) : 0.0) - seg.shift);
+    } else {
+        float m = sqrt(-p * (1.0 / 3.0));
+        float theta = acos(clamp(-q / (2.0 * m * m * m), -1.0, 1.0)) * (1.0 / 3.0);
+
+        float cos_theta = cos(theta);
+        float sin_theta = sin(theta) * 1.7320508;
+
+        ts = vec2(2.0 * m * cos_theta, -m * (cos_theta + sin_theta)) - seg.shift;
     }
 
-    vec2 bez_dir = normalize(t * c2 + c1);
-    vec2 point_dir = bez_to_point / dist;
+    float c = seg.c_base - c2_c0;
+    vec2 f = ((seg.a * ts + seg.b) * ts + c) * ts - c1_c0;
+    vec2 df = (3.0 * seg.a * ts + 2.0 * seg.b) * ts + c;
+    ts = clamp(ts - mix(vec2(0.0), f / df, notEqual(df, vec2(0.0))), 0.0, 1.0);
 
-    float ortho = cross(bez_dir, point_dir);
-    float s = ortho < 0.0 ? -1 : 1;
+    vec2 b0 = p0 + ts.x * (2.0 * c1 + ts.x * c2);
+    vec2 b1 = p0 + ts.y * (2.0 * c1 + ts.y * c2);
 
-    return dist_info(s * dist, s * ortho, t);
+    float t = dot(pos - b0, pos - b0) <= dot(pos - b1, pos - b1) ? ts.x : ts.y;
+
+    return make_dist(p0 + t * (2.0 * c1 + t * c2), t * c2 + c1, t);
 }
 
 bool dist_less(dist_info a, dist_info b) {
@@ -195,63 +157,43 @@ bool dist_less(dist_info a, dist_info b) {
     return false;
 }
 
-uint get_flag(uint flag_index) {
-    uint offset = instances[glyph_id].data_offset / 4;
-
-    uint flag = glyph_packed[offset + flag_index / 4];
-    flag = (flag >> ((flag_index % 4) * 8)) & 0xff;
-
-    return flag;
-}
-
-vec2 get_point(uint data_index) {
-    uint offset = instances[glyph_id].data_offset / 4;
-    vec2 p = unpackSnorm2x16(glyph_packed[offset + data_index]) * 32727.0;
-
-    p *= instances[glyph_id].scale;
-    p += instances[glyph_id].translate;
-
-    return p;
-}
-
 void main() {
-    uint num_segments = instances[glyph_id].num_segments;
-    uint num_points = instances[glyph_id].num_points;
+    instance_data inst = instances[glyph_id];
 
-    uint point_offset = (num_points + 3) / 4;
-    uint point_index = 0;
+    pos = (world_pos - inst.translate) / inst.scale;
 
-    dist_info dist = dist_info(INFINITY, 0, 0);
-
-    for (uint i = 0; i < num_segments; i++) {
-        uint flag = get_flag(point_index);
+    uint first_segment = inst.data_offset;
+    uint num_segments = inst.num_segments;
 
-        dist_info cur_dist = dist_info(INFINITY, 0, 0);
+    // Flipping an axis mirrors the outline, which flips
+    // the side distances are measured from
+    float flip = sign(inst.scale.x * inst.scale.y);
 
-        if ((flag & POINT_FLAG_LINE) == POINT_FLAG_LINE) {
-            vec2 p0 = get_point(point_offset + point_index++);
-            vec2 p1 = get_point(point_offset + point_index);
+    dist_info dist = dist_info(flip * INFINITY, 0, 0);
 
-            cur_dist = line_dist(p0, p1);
-        } else {
-            vec2 p0 = get_point(point_offset + point_index++);
-            vec2 p1 = get_point(point_offset + point_index++);
-            vec2 p2 = get_point(point_offset + point_index);
+    for (uint i = 0; i < num_segments; i++) {
+        segment seg = load_segment(first_segment + i * SEGMENT_SIZE);
 
-            cur_dist = bez_dist(p0, p1, p2);
+        // Segments whose bounding box is further than the closest
+        // segment so far cannot be closer
+        vec2 box_dist = max(
+            max(vec2(seg.min_x, seg.min_y) - pos, pos - vec2(seg.max_x, seg.max_y)),
+            vec2(0.0)
+        );
+        if (length(box_dist) > abs(dist.sdist)) {
+            continue;
         }
 
-        flag = get_flag(point_index);
-        if ((flag & POINT_FLAG_CONTOUR_END) == POINT_FLAG_CONTOUR_END) {
-            point_index++;
-        }
+        dist_info cur_dist = (seg.flags & POINT_FLAG_LINE) == POINT_FLAG_LINE ?
+            line_dist(seg) : bez_dist(seg);
 
         if (dist_less(cur_dist, dist)) {
             dist = cur_dist;
         }
     }
 
-    float d = dist.sdist;
+    // Back to world units
+    float d = dist.sdist * abs(inst.scale.x) * flip;
     d = clamp(d, -10.0, 10.0);
     float outline = 1 / ((20 * d) * (20 * d) + 1);
     d = d / 20.0 + 0.5;